@@ -0,0 +1,184 @@
+#include "association_batch_filter.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#define ASSOCIATION_BATCH_FILTER_SSE2
+#endif
+
+#if defined(ASSOCIATION_BATCH_FILTER_SSE2) && ( defined(__GNUC__) || defined(__clang__) )
+#define ASSOCIATION_BATCH_FILTER_AVX2
+#endif
+
+namespace {
+
+// field masks of PackedAssociationInfo::getValue()
+constexpr uint64_t SourceDeviceMask = uint64_t( 0xFFFF ) << 48;
+constexpr uint64_t SourceChannelMask = uint64_t( 0xFF ) << 40;
+constexpr uint64_t TargetDeviceMask = uint64_t( 0xFFFF ) << 16;
+constexpr uint64_t TargetChannelMask = uint64_t( 0xFF ) << 8;
+
+using Kernel = void (*)(const PackedAssociationInfo* rows, size_t count, uint64_t mask, uint64_t pattern, uint64_t* words);
+
+// each kernel writes whole words; rows of the last one beyond count stay 0
+void matchScalar(const PackedAssociationInfo* rows, size_t count, uint64_t mask, uint64_t pattern, uint64_t* words) {
+    for ( size_t first = 0; first < count; first += 64 ) {
+        const size_t last = std::min( count, first + 64 );
+        uint64_t word = 0;
+
+        for ( size_t row = first; row < last; ++row ) {
+            word |= uint64_t( ( rows[row].getValue() & mask ) == pattern ) << ( row - first );
+        }
+
+        words[first / 64] = word;
+    }
+}
+
+#ifdef ASSOCIATION_BATCH_FILTER_SSE2
+
+void matchSse2(const PackedAssociationInfo* rows, size_t count, uint64_t mask, uint64_t pattern, uint64_t* words) {
+    const __m128i maskVector = _mm_set1_epi64x( static_cast<long long>( mask ) );
+    const __m128i patternVector = _mm_set1_epi64x( static_cast<long long>( pattern ) );
+
+    const size_t vectorCount = count / 64 * 64;
+
+    for ( size_t first = 0; first < vectorCount; first += 64 ) {
+        uint64_t word = 0;
+
+        for ( size_t row = 0; row < 64; row += 2 ) {
+            const __m128i values = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rows + first + row ) );
+            // SSE2 compares 32-bit lanes only: a 64-bit row matches when both of its halves do
+            const __m128i halves = _mm_cmpeq_epi32( _mm_and_si128( values, maskVector ), patternVector );
+            const __m128i equal = _mm_and_si128( halves, _mm_shuffle_epi32( halves, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+            word |= uint64_t( _mm_movemask_pd( _mm_castsi128_pd( equal ) ) ) << row;
+        }
+
+        words[first / 64] = word;
+    }
+
+    if ( vectorCount < count )
+        matchScalar( rows + vectorCount, count - vectorCount, mask, pattern, words + vectorCount / 64 );
+}
+
+#endif
+
+#ifdef ASSOCIATION_BATCH_FILTER_AVX2
+
+__attribute__((target("avx2")))
+void matchAvx2(const PackedAssociationInfo* rows, size_t count, uint64_t mask, uint64_t pattern, uint64_t* words) {
+    const __m256i maskVector = _mm256_set1_epi64x( static_cast<long long>( mask ) );
+    const __m256i patternVector = _mm256_set1_epi64x( static_cast<long long>( pattern ) );
+
+    const size_t vectorCount = count / 64 * 64;
+
+    for ( size_t first = 0; first < vectorCount; first += 64 ) {
+        uint64_t word = 0;
+
+        for ( size_t row = 0; row < 64; row += 4 ) {
+            const __m256i values = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( rows + first + row ) );
+            const __m256i equal = _mm256_cmpeq_epi64( _mm256_and_si256( values, maskVector ), patternVector );
+
+            word |= uint64_t( _mm256_movemask_pd( _mm256_castsi256_pd( equal ) ) ) << row;
+        }
+
+        words[first / 64] = word;
+    }
+
+    if ( vectorCount < count )
+        matchScalar( rows + vectorCount, count - vectorCount, mask, pattern, words + vectorCount / 64 );
+}
+
+#endif
+
+struct KernelInfo {
+    Kernel kernel;
+    const char* name;
+};
+
+KernelInfo selectKernel() {
+#ifdef ASSOCIATION_BATCH_FILTER_AVX2
+    if ( __builtin_cpu_supports( "avx2" ) )
+        return { &matchAvx2, "avx2" };
+#endif
+
+#ifdef ASSOCIATION_BATCH_FILTER_SSE2
+    return { &matchSse2, "sse2" };
+#else
+    return { &matchScalar, "scalar" };
+#endif
+}
+
+const KernelInfo& getKernel() {
+    static const KernelInfo kernel = selectKernel();
+
+    return kernel;
+}
+
+}
+
+AssociationBatchFilter::AssociationBatchFilter(const DevicesModel& model, const FilterInfo& filterInfo) {
+    // fields with several values are checked with the group names after the kernel
+    FilterInfo residualFilter;
+    residualFilter.groupNames = filterInfo.groupNames;
+
+    auto addField = [this](const IndexSet& values, IndexSet& residualValues, uint64_t fieldMask, int shift) {
+        if ( values.getSize() > 1 ) {
+            residualValues = values;
+            return;
+        }
+
+        if ( values.isEmpty() )
+            return;
+
+        const size_t value = values.getFirst();
+
+        // a value that does not fit its field matches no row
+        if ( value > ( fieldMask >> shift ) )
+            m_rejectsAll = true;
+
+        m_mask |= fieldMask;
+        m_pattern |= uint64_t( value ) << shift & fieldMask;
+    };
+
+    addField( filterInfo.deviceIndices, residualFilter.deviceIndices, SourceDeviceMask, 48 );
+    addField( filterInfo.channelIndices, residualFilter.channelIndices, SourceChannelMask, 40 );
+    addField( filterInfo.targetDeviceIndices, residualFilter.targetDeviceIndices, TargetDeviceMask, 16 );
+    addField( filterInfo.targetChannels, residualFilter.targetChannels, TargetChannelMask, 8 );
+
+    if ( !residualFilter.isEmpty() ) {
+        m_residualActive = true;
+        m_residualFilter = AssociationFilter( model, residualFilter );
+    }
+}
+
+void AssociationBatchFilter::match(const PackedAssociationInfo* rows, size_t count, uint64_t* words) const {
+    const size_t wordsCount = ( count + 63 ) / 64;
+
+    if ( m_rejectsAll ) {
+        std::memset( words, 0, wordsCount * sizeof(uint64_t) );
+        return;
+    }
+
+    getKernel().kernel( rows, count, m_mask, m_pattern, words );
+
+    if ( !m_residualActive )
+        return;
+
+    for ( size_t wordIndex = 0; wordIndex < wordsCount; ++wordIndex ) {
+        if ( words[wordIndex] == 0 )
+            continue;
+
+        for ( size_t bit = 0; bit < 64; ++bit ) {
+            const uint64_t rowBit = uint64_t( 1 ) << bit;
+
+            if ( ( words[wordIndex] & rowBit ) != 0 && !m_residualFilter( rows[wordIndex * 64 + bit].unpack() ) )
+                words[wordIndex] &= ~rowBit;
+        }
+    }
+}
+
+const char* AssociationBatchFilter::getKernelName() {
+    return getKernel().name;
+}
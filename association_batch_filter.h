@@ -0,0 +1,65 @@
+#pragma once
+
+#include "association_filter.h"
+#include "association_info.h"
+#include "devices_model.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per row: row r is bit r % 64 of word r / 64.
+using RowBitmap = std::vector<uint64_t>;
+
+inline bool testRow(const RowBitmap& bitmap, size_t row) {
+    return ( bitmap[row / 64] >> ( row % 64 ) & 1 ) != 0;
+}
+
+inline void setRow(RowBitmap& bitmap, size_t row) {
+    bitmap[row / 64] |= uint64_t( 1 ) << ( row % 64 );
+}
+
+// Filters rows in batches straight on their packed values. Source device and channel, target device and
+// target channel are all bit fields of PackedAssociationInfo, so fields with a single value are together one
+// mask and compare per row, done 4 rows at a time with AVX2 (chosen at run time), 2 with SSE2 or one by one
+// elsewhere. Group names, which are not in the packed value, and fields with several values are checked
+// afterwards, only for the rows that passed.
+class AssociationBatchFilter
+{
+public:
+    // rows copied and filtered at once, a multiple of 64 so that batches fill whole bitmap words
+    static constexpr size_t BatchSize = 4096;
+
+    AssociationBatchFilter(const DevicesModel& model, const FilterInfo& filterInfo);
+
+    // Writes the words of rows [0, count) to words, which must hold (count + 63) / 64 of them.
+    void match(const PackedAssociationInfo* rows, size_t count, uint64_t* words) const;
+
+    // copyRows(firstRow, count, rows) fills rows with the packed rows [firstRow, firstRow + count).
+    template<typename RowsCopier>
+    RowBitmap match(size_t rowsCount, RowsCopier copyRows) const {
+        RowBitmap bitmap( ( rowsCount + 63 ) / 64, 0 );
+        std::vector<PackedAssociationInfo> rows( std::min( rowsCount, BatchSize ) );
+
+        for ( size_t firstRow = 0; firstRow < rowsCount; firstRow += BatchSize ) {
+            const size_t count = std::min( BatchSize, rowsCount - firstRow );
+
+            copyRows( firstRow, count, rows.data() );
+            match( rows.data(), count, bitmap.data() + firstRow / 64 );
+        }
+
+        return bitmap;
+    }
+
+    // "avx2", "sse2" or "scalar"
+    static const char* getKernelName();
+
+private:
+    uint64_t m_mask = 0;
+    uint64_t m_pattern = 0;
+    bool m_rejectsAll = false;
+
+    bool m_residualActive = false;
+    AssociationFilter m_residualFilter;
+};
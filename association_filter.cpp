@@ -0,0 +1,43 @@
+#include "association_filter.h"
+
+#include <algorithm>
+
+AssociationFilter::AssociationFilter() :
+    m_matches( &matches<0> )
+{
+}
+
+AssociationFilter::AssociationFilter(const DevicesModel& model, const FilterInfo& filterInfo) :
+    m_deviceIndices(filterInfo.deviceIndices),
+    m_channelIndices(filterInfo.channelIndices),
+    m_targetDeviceIndices(filterInfo.targetDeviceIndices),
+    m_targetChannels(filterInfo.targetChannels)
+{
+    if ( !m_deviceIndices.isEmpty() )
+        m_fields |= SourceDeviceField;
+
+    if ( !m_channelIndices.isEmpty() )
+        m_fields |= SourceChannelField;
+
+    if ( !filterInfo.groupNames.empty() ) {
+        m_fields |= GroupNameField;
+        m_flat = model.getFlatAssociationsSnapshot();
+        m_devicesCount = m_flat->channelOffsets.size() - 1;
+
+        for ( size_t nameId = 0; nameId < m_flat->groupNames.size(); ++nameId ) {
+            if ( std::find( filterInfo.groupNames.begin(), filterInfo.groupNames.end(), m_flat->groupNames[nameId] ) != filterInfo.groupNames.end() )
+                m_groupNameIds.insert( nameId );
+        }
+    }
+
+    if ( !m_targetDeviceIndices.isEmpty() )
+        m_fields |= TargetDeviceField;
+
+    if ( !m_targetChannels.isEmpty() )
+        m_fields |= TargetChannelField;
+
+    static constexpr auto Matchers = createMatchers( std::make_integer_sequence<unsigned, FieldsCombinationsNumber>() );
+
+    // names that no group has match nothing, whatever the other fields
+    m_matches = ( m_fields & GroupNameField ) != 0 && m_groupNameIds.isEmpty() ? &rejects : Matchers[m_fields];
+}
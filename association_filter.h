@@ -0,0 +1,123 @@
+#pragma once
+
+#include "association_info.h"
+#include "devices_model.h"
+#include "flat_associations.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// FilterInfo compiled once per setFilter() into the specialization for its set of active fields, one of 32:
+// group names are resolved to a set of interned ids and each row is checked with bitset lookups of the active
+// fields only, combined without branches. Group ids come from the network at compile time, so device changes,
+// which rebuild the rows anyway, need a new filter.
+class AssociationFilter
+{
+public:
+    enum Field : unsigned {
+        SourceDeviceField = 1,
+        SourceChannelField = 2,
+        GroupNameField = 4,
+        TargetDeviceField = 8,
+        TargetChannelField = 16
+    };
+
+    static constexpr unsigned FieldsCombinationsNumber = 32;
+
+    // Accepts every row.
+    AssociationFilter();
+
+    AssociationFilter(const DevicesModel& model, const FilterInfo& filterInfo);
+
+    unsigned getFields() const {
+        return m_fields;
+    }
+
+    bool operator () (const AssociationInfo& info) const {
+        return m_matches( *this, info );
+    }
+
+    // Calls function with the predicate of the active fields as a concrete callable, so that a loop over
+    // rows written in function is instantiated per combination with the comparisons inlined.
+    template<typename Function>
+    void visit(Function&& function) const {
+        if ( m_matches == &rejects ) {
+            function( [](const AssociationInfo&) { return false; } );
+            return;
+        }
+
+        visitFields<0>( function );
+    }
+
+private:
+    using Matcher = bool (*)(const AssociationFilter&, const AssociationInfo&);
+
+    template<unsigned Fields>
+    static bool matches(const AssociationFilter& filter, const AssociationInfo& info) {
+        bool result = true;
+
+        if constexpr ( ( Fields & SourceDeviceField ) != 0 )
+            result &= filter.m_deviceIndices.contains( info.deviceIndex );
+
+        if constexpr ( ( Fields & SourceChannelField ) != 0 )
+            result &= filter.m_channelIndices.contains( info.channelIndex );
+
+        if constexpr ( ( Fields & GroupNameField ) != 0 )
+            result &= filter.m_groupNameIds.contains( filter.getGroupNameId( info ) );
+
+        if constexpr ( ( Fields & TargetDeviceField ) != 0 )
+            result &= filter.m_targetDeviceIndices.contains( info.targetDeviceIndex );
+
+        if constexpr ( ( Fields & TargetChannelField ) != 0 )
+            result &= filter.m_targetChannels.contains( FilterInfo::encodeTargetChannel( info.targetChannelIndex ) );
+
+        return result;
+    }
+
+    template<unsigned Fields, typename Function>
+    void visitFields(Function& function) const {
+        if constexpr ( Fields + 1 < FieldsCombinationsNumber ) {
+            if ( m_fields != Fields ) {
+                visitFields<Fields + 1>( function );
+                return;
+            }
+        }
+
+        function( [this](const AssociationInfo& info) {
+            return matches<Fields>( *this, info );
+        } );
+    }
+
+    static bool rejects(const AssociationFilter&, const AssociationInfo&) {
+        return false;
+    }
+
+    template<unsigned... Fields>
+    static constexpr std::array<Matcher, sizeof...(Fields)> createMatchers(std::integer_sequence<unsigned, Fields...>) {
+        return { &matches<Fields>... };
+    }
+
+    // devices added after the filter was compiled have no group id, which matches no name
+    uint32_t getGroupNameId(const AssociationInfo& info) const {
+        return info.deviceIndex < m_devicesCount ?
+                   m_flat->groupNameIds[m_flat->getGroupId( info.deviceIndex, info.channelIndex, info.groupIndex )] :
+                   NoGroupNameId;
+    }
+
+    static constexpr uint32_t NoGroupNameId = UINT32_MAX;
+
+private:
+    Matcher m_matches;
+    unsigned m_fields = 0;
+
+    IndexSet m_deviceIndices;
+    IndexSet m_channelIndices;
+    IndexSet m_groupNameIds;
+    IndexSet m_targetDeviceIndices;
+    IndexSet m_targetChannels;
+
+    std::shared_ptr<const FlatAssociations> m_flat;
+    size_t m_devicesCount = 0;
+};
@@ -0,0 +1,130 @@
+#include "association_filter_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+void AssociationFilterIndex::clear() {
+    m_rowsCount = 0;
+
+    for ( auto& postings : m_postings ) {
+        postings.clear();
+    }
+
+    m_groupNameIds.clear();
+}
+
+size_t AssociationFilterIndex::getRowsCount() const {
+    return m_rowsCount;
+}
+
+RowBitmap AssociationFilterIndex::match(const FilterInfo& filterInfo) const {
+    std::vector<const std::vector<Row>*> lists;
+    bool emptyResult = false;
+
+    // rows of several values of one column are marked in a bitmap, which costs no sorting and is ANDed into the result
+    std::vector<RowBitmap> unions;
+
+    auto addUnion = [&](const std::vector<const std::vector<Row>*>& columnLists) {
+        if ( columnLists.empty() ) {
+            emptyResult = true;
+        }
+        else if ( columnLists.size() == 1 ) {
+            lists.push_back( columnLists.front() );
+        }
+        else {
+            RowBitmap rows( ( m_rowsCount + 63 ) / 64, 0 );
+            for ( auto columnList : columnLists ) {
+                for ( auto row : *columnList ) {
+                    setRow( rows, row );
+                }
+            }
+
+            unions.push_back( std::move( rows ) );
+        }
+    };
+
+    auto addColumn = [&](Column column, const IndexSet& values) {
+        if ( values.isEmpty() )
+            return;
+
+        const auto& postings = m_postings[column];
+        std::vector<const std::vector<Row>*> columnLists;
+
+        values.forEach( [&](size_t value) {
+            if ( value < postings.size() && !postings[value].empty() )
+                columnLists.push_back( &postings[value] );
+        } );
+
+        addUnion( columnLists );
+    };
+
+    addColumn( SourceDevice, filterInfo.deviceIndices );
+    addColumn( SourceChannel, filterInfo.channelIndices );
+
+    if ( !filterInfo.groupNames.empty() ) {
+        const auto& postings = m_postings[GroupName];
+        std::vector<const std::vector<Row>*> columnLists;
+
+        for ( const auto& groupName : filterInfo.groupNames ) {
+            auto it = m_groupNameIds.find( groupName );
+
+            if ( it != m_groupNameIds.end() && it->second < postings.size() && !postings[it->second].empty() &&
+                 std::find( columnLists.begin(), columnLists.end(), &postings[it->second] ) == columnLists.end() )
+                columnLists.push_back( &postings[it->second] );
+        }
+
+        addUnion( columnLists );
+    }
+
+    addColumn( TargetDevice, filterInfo.targetDeviceIndices );
+    addColumn( TargetChannel, filterInfo.targetChannels );
+
+    if ( emptyResult )
+        return RowBitmap( ( m_rowsCount + 63 ) / 64, 0 );
+
+    RowBitmap result;
+
+    if ( lists.empty() ) {
+        result.assign( ( m_rowsCount + 63 ) / 64, ~uint64_t( 0 ) );
+        if ( m_rowsCount % 64 != 0 )
+            result.back() = ( uint64_t( 1 ) << ( m_rowsCount % 64 ) ) - 1;
+    }
+    else {
+        std::sort( lists.begin(), lists.end(), [](const std::vector<Row>* a, const std::vector<Row>* b) {
+            return a->size() < b->size();
+        } );
+
+        std::vector<Row> rows = *lists.front();
+        std::vector<Row> intersection;
+
+        for ( auto it = lists.begin() + 1; it != lists.end() && !rows.empty(); ++it ) {
+            intersection.clear();
+            std::set_intersection( rows.begin(), rows.end(), (*it)->begin(), (*it)->end(), std::back_inserter( intersection ) );
+            rows.swap( intersection );
+        }
+
+        result.assign( ( m_rowsCount + 63 ) / 64, 0 );
+
+        for ( auto row : rows ) {
+            setRow( result, row );
+        }
+    }
+
+    for ( const auto& rows : unions ) {
+        for ( size_t wordIndex = 0; wordIndex < result.size(); ++wordIndex ) {
+            result[wordIndex] &= rows[wordIndex];
+        }
+    }
+
+    return result;
+}
+
+void AssociationFilterIndex::addPosting(Column column, size_t value, size_t row) {
+    auto& postings = m_postings[column];
+
+    if ( postings.size() <= value ) {
+        postings.resize( value + 1 );
+    }
+
+    postings[value].push_back( static_cast<Row>( row ) );
+}
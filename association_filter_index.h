@@ -0,0 +1,69 @@
+#pragma once
+
+#include "association_batch_filter.h"
+#include "association_info.h"
+#include "devices_model.h"
+#include "flat_associations.h"
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <cstdint>
+#include <limits>
+
+// Posting lists (ascending row numbers) per value of every filterable column of an association list.
+// A filter is answered by intersecting the lists of its active fields instead of testing every row; a field
+// with several values contributes the bitmap of all their rows instead of one list.
+class AssociationFilterIndex
+{
+public:
+    using Row = uint32_t;
+
+    static constexpr size_t MaxRowsCount = std::numeric_limits<Row>::max();
+
+    template<typename RowAccessor>
+    void build(const DevicesModel& model, size_t rowsCount, RowAccessor rowAt) {
+        clear();
+
+        const auto& flat = model.getFlatAssociations();
+
+        for ( size_t nameId = 0; nameId < flat.groupNames.size(); ++nameId ) {
+            m_groupNameIds.emplace( flat.groupNames[nameId], nameId );
+        }
+
+        m_rowsCount = rowsCount;
+
+        for ( size_t row = 0; row < rowsCount; ++row ) {
+            const AssociationInfo info = rowAt( row );
+
+            addPosting( SourceDevice, info.deviceIndex, row );
+            addPosting( SourceChannel, info.channelIndex, row );
+            addPosting( GroupName, flat.groupNameIds[flat.getGroupId( info.deviceIndex, info.channelIndex, info.groupIndex )], row );
+            addPosting( TargetDevice, info.targetDeviceIndex, row );
+            addPosting( TargetChannel, FilterInfo::encodeTargetChannel( info.targetChannelIndex ), row );
+        }
+    }
+
+    void clear();
+
+    size_t getRowsCount() const;
+
+    RowBitmap match(const FilterInfo& filterInfo) const;
+
+private:
+    enum Column {
+        SourceDevice,
+        SourceChannel,
+        GroupName,
+        TargetDevice,
+        TargetChannel,
+        ColumnsCount
+    };
+
+    void addPosting(Column column, size_t value, size_t row);
+
+private:
+    size_t m_rowsCount = 0;
+    std::array<std::vector<std::vector<Row>>, ColumnsCount> m_postings;
+    std::unordered_map<std::string, size_t> m_groupNameIds;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct AssociationInfo {
+    size_t deviceIndex;
+    size_t channelIndex;
+    size_t groupIndex;
+    size_t targetDeviceIndex;
+    std::optional<size_t> targetChannelIndex;
+
+    bool operator == (const AssociationInfo& other) const {
+        return deviceIndex == other.deviceIndex && channelIndex == other.channelIndex && groupIndex == other.groupIndex &&
+                targetDeviceIndex == other.targetDeviceIndex && targetChannelIndex == other.targetChannelIndex;
+    }
+};
+
+// AssociationInfo in 8 bytes, for the row lists and caches that hold one entry per association.
+// Source fields occupy the high half, so ordering by value orders by (device, channel, group) first.
+// The ranges are the DevicesModel limits (MaxDevicesNumber, MaxChannelsNumber, MaxGroupsNumber),
+// which are checked where devices and associations enter the model.
+class PackedAssociationInfo {
+public:
+    PackedAssociationInfo() = default;
+
+    explicit PackedAssociationInfo(const AssociationInfo& info) :
+        m_value( uint64_t( info.deviceIndex ) << 48 | uint64_t( info.channelIndex ) << 40 | uint64_t( info.groupIndex ) << 32 |
+                 uint64_t( info.targetDeviceIndex ) << 16 | uint64_t( info.targetChannelIndex ? *info.targetChannelIndex + 1 : 0 ) << 8 )
+    { }
+
+    AssociationInfo unpack() const {
+        const auto targetChannel = static_cast<size_t>( m_value >> 8 & 0xFF );
+
+        return { getDeviceIndex(), static_cast<size_t>( m_value >> 40 & 0xFF ), static_cast<size_t>( m_value >> 32 & 0xFF ),
+                 getTargetDeviceIndex(), targetChannel == 0 ? std::optional<size_t>() : std::optional<size_t>( targetChannel - 1 ) };
+    }
+
+    size_t getDeviceIndex() const {
+        return static_cast<size_t>( m_value >> 48 );
+    }
+
+    size_t getTargetDeviceIndex() const {
+        return static_cast<size_t>( m_value >> 16 & 0xFFFF );
+    }
+
+    uint32_t getSourceKey() const {
+        return static_cast<uint32_t>( m_value >> 32 );
+    }
+
+    uint64_t getValue() const {
+        return m_value;
+    }
+
+    bool operator == (const PackedAssociationInfo& other) const {
+        return m_value == other.m_value;
+    }
+
+private:
+    uint64_t m_value = 0;
+};
+
+static_assert( sizeof(PackedAssociationInfo) == 8, "PackedAssociationInfo must stay 8 bytes" );
+
+struct PackedAssociationInfoHash {
+    size_t operator () (const PackedAssociationInfo& info) const {
+        return std::hash<uint64_t>()( info.getValue() );
+    }
+};
+
+// Compares rows with a source key for std::equal_range over rows sorted by source.
+struct PackedSourceLess {
+    bool operator () (const PackedAssociationInfo& info, uint32_t sourceKey) const {
+        return info.getSourceKey() < sourceKey;
+    }
+
+    bool operator () (uint32_t sourceKey, const PackedAssociationInfo& info) const {
+        return sourceKey < info.getSourceKey();
+    }
+};
+
+// A set of small indices as a bitset, so checking a row against it is a word load and a shift.
+class IndexSet {
+public:
+    IndexSet() = default;
+
+    IndexSet(std::initializer_list<size_t> values) {
+        for ( auto value : values ) {
+            insert( value );
+        }
+    }
+
+    void insert(size_t value) {
+        if ( m_words.size() <= value / 64 )
+            m_words.resize( value / 64 + 1, 0 );
+
+        if ( !contains( value ) ) {
+            m_words[value / 64] |= uint64_t( 1 ) << ( value % 64 );
+            ++m_size;
+        }
+    }
+
+    bool contains(size_t value) const {
+        return value / 64 < m_words.size() && ( m_words[value / 64] >> ( value % 64 ) & 1 ) != 0;
+    }
+
+    bool isEmpty() const {
+        return m_size == 0;
+    }
+
+    size_t getSize() const {
+        return m_size;
+    }
+
+    // Calls function(value) in ascending order.
+    template<typename Function>
+    void forEach(Function function) const {
+        for ( size_t wordIndex = 0; wordIndex < m_words.size(); ++wordIndex ) {
+            for ( size_t bit = 0; bit < 64 && m_words[wordIndex] >> bit != 0; ++bit ) {
+                if ( ( m_words[wordIndex] >> bit & 1 ) != 0 )
+                    function( wordIndex * 64 + bit );
+            }
+        }
+    }
+
+    // The smallest value of a non-empty set.
+    size_t getFirst() const {
+        size_t first = 0;
+        bool found = false;
+
+        forEach( [&](size_t value) {
+            if ( !found ) {
+                first = value;
+                found = true;
+            }
+        } );
+
+        return first;
+    }
+
+private:
+    std::vector<uint64_t> m_words;
+    size_t m_size = 0;
+};
+
+// A row passes when each of its fields is in the matching set; an empty set does not filter its field.
+struct FilterInfo {
+    IndexSet deviceIndices;
+    IndexSet channelIndices;
+    std::vector<std::string> groupNames;
+    IndexSet targetDeviceIndices;
+    // encoded with encodeTargetChannel()
+    IndexSet targetChannels;
+
+    // the whole node is 0, channel c is c + 1, as in PackedAssociationInfo
+    static size_t encodeTargetChannel(std::optional<size_t> channelIndex) {
+        return channelIndex ? *channelIndex + 1 : 0;
+    }
+
+    static std::optional<size_t> decodeTargetChannel(size_t channel) {
+        return channel == 0 ? std::optional<size_t>() : std::optional<size_t>( channel - 1 );
+    }
+
+    bool isEmpty() const {
+        return deviceIndices.isEmpty() && channelIndices.isEmpty() && groupNames.empty() && targetDeviceIndices.isEmpty() && targetChannels.isEmpty();
+    }
+};
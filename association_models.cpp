@@ -0,0 +1,850 @@
+#include "association_models.h"
+#include "association_ranking.h"
+#include "flat_associations.h"
+#include "parallel_for.h"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+QString associationToString(const DevicesModel& model, const AssociationInfo& associationInfo) {
+    auto& device = model.getDevices()[ associationInfo.deviceIndex ];
+    auto& targetDevice = model.getDevices()[ associationInfo.targetDeviceIndex ];
+
+    std::stringstream stream;
+    stream << "Source: " << device.name << " [node: " << device.nodeId << "; channel: " << associationInfo.channelIndex << "; group: " << device.channelsToGroups[associationInfo.channelIndex][associationInfo.groupIndex].name << "]" <<
+              "\nTarget: " << targetDevice.name << " [node: " << targetDevice.nodeId;
+    if (associationInfo.targetChannelIndex) {
+        stream << "; channel: " << *associationInfo.targetChannelIndex;
+    }
+
+    stream << "]";
+
+    return QString::fromStdString(stream.str());
+}
+
+AssociationTextCache::AssociationTextCache(size_t capacity) :
+    m_capacity(capacity)
+{ }
+
+const QString& AssociationTextCache::getText(const DevicesModel& model, const AssociationInfo& info) {
+    if ( m_texts.size() <= info.deviceIndex ) {
+        m_texts.resize( info.deviceIndex + 1 );
+    }
+
+    auto& texts = m_texts[info.deviceIndex];
+    const PackedAssociationInfo key( info );
+
+    auto it = texts.find( key );
+    if ( it != texts.end() ) {
+        ++m_hits;
+        return it->second;
+    }
+
+    ++m_misses;
+
+    if ( m_size >= m_capacity ) {
+        clear();
+    }
+
+    ++m_size;
+    return texts.emplace( key, associationToString( model, info ) ).first->second;
+}
+
+void AssociationTextCache::clear() {
+    for ( auto& texts : m_texts ) {
+        texts.clear();
+    }
+
+    m_size = 0;
+}
+
+size_t AssociationTextCache::getHits() const {
+    return m_hits;
+}
+
+size_t AssociationTextCache::getMisses() const {
+    return m_misses;
+}
+
+BaseSourceModel::BaseSourceModel(const DevicesModel& model) :
+    m_model(model)
+{ }
+
+QVariant BaseSourceModel::data(const QModelIndex &index, int role) const {
+    if ( role == Qt::DisplayRole ) {
+        return m_textCache.getText( m_model, getAssociation( index.row() ) );
+    }
+
+    return {};
+}
+
+int BaseSourceModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>( getAssociationsCount() );
+}
+
+void BaseSourceModel::copyRows(size_t firstRow, size_t count, PackedAssociationInfo* rows) const {
+    for ( size_t index = 0; index < count; ++index ) {
+        rows[index] = PackedAssociationInfo( getAssociation( firstRow + index ) );
+    }
+}
+
+bool BaseSourceModel::findTargetRows(size_t, std::optional<std::optional<size_t>>, std::vector<size_t>&) const {
+    return false;
+}
+
+bool BaseSourceModel::storesRows() const {
+    return false;
+}
+
+const DevicesModel& BaseSourceModel::getDevicesModel() const {
+    return m_model;
+}
+
+const AssociationTextCache& BaseSourceModel::getTextCache() const {
+    return m_textCache;
+}
+
+void BaseSourceModel::updateGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex) {
+    std::vector<AssociationInfo> newReferences;
+    appendGroupReferences( deviceIndex, channelIndex, groupIndex, newReferences );
+
+    const auto [first, oldCount] = getGroupRows( deviceIndex, channelIndex, groupIndex );
+    const size_t newCount = newReferences.size();
+
+    size_t prefix = 0;
+    while ( prefix < oldCount && prefix < newCount &&
+            getAssociation( first + prefix ) == newReferences[prefix] ) {
+        ++prefix;
+    }
+
+    size_t suffix = 0;
+    while ( suffix < oldCount - prefix && suffix < newCount - prefix &&
+            getAssociation( first + oldCount - 1 - suffix ) == newReferences[newCount - 1 - suffix] ) {
+        ++suffix;
+    }
+
+    const size_t oldChanged = oldCount - prefix - suffix;
+    const size_t newChanged = newCount - prefix - suffix;
+    const int changedRow = static_cast<int>( first + prefix );
+
+    if ( oldChanged > newChanged ) {
+        beginRemoveRows( {}, changedRow + newChanged, changedRow + oldChanged - 1 );
+        setGroupReferences( deviceIndex, channelIndex, groupIndex, first, oldCount, std::move( newReferences ) );
+        endRemoveRows();
+    }
+    else if ( newChanged > oldChanged ) {
+        beginInsertRows( {}, changedRow + oldChanged, changedRow + newChanged - 1 );
+        setGroupReferences( deviceIndex, channelIndex, groupIndex, first, oldCount, std::move( newReferences ) );
+        endInsertRows();
+    }
+    else {
+        setGroupReferences( deviceIndex, channelIndex, groupIndex, first, oldCount, std::move( newReferences ) );
+    }
+
+    const auto replacedCount = std::min( oldChanged, newChanged );
+    if ( replacedCount > 0 ) {
+        emit dataChanged( index( changedRow ), index( changedRow + replacedCount - 1 ) );
+    }
+}
+
+void SourceModel::appendGroupReferences(const DevicesModel& model, size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result) {
+    const auto& group = model.getDevices()[deviceIndex].channelsToGroups[channelIndex][groupIndex];
+
+    for ( const auto& association : group.associations ) {
+        AssociationInfo info;
+        info.deviceIndex = deviceIndex;
+        info.channelIndex = channelIndex;
+        info.groupIndex = groupIndex;
+        info.targetDeviceIndex = association.deviceIndex;
+        info.targetChannelIndex = association.channelIndex;
+
+        result.push_back( info );
+    }
+}
+
+std::vector<PackedAssociationInfo> SourceModel::createAssociationReferences(const DevicesModel& model) {
+    return createAssociationReferences( model.getFlatAssociations() );
+}
+
+std::vector<PackedAssociationInfo> SourceModel::createAssociationReferences(const FlatAssociations& flat) {
+    std::vector<PackedAssociationInfo> result;
+    result.reserve( flat.targetDevices.size() );
+
+    for ( size_t group = 0; group < flat.getGroupsCount(); ++group ) {
+        AssociationInfo info;
+        info.deviceIndex = flat.groupDevices[group];
+        info.channelIndex = flat.groupChannels[group];
+        info.groupIndex = flat.groupIndices[group];
+
+        for ( size_t association = flat.associationOffsets[group]; association < flat.associationOffsets[group + 1]; ++association ) {
+            info.targetDeviceIndex = flat.targetDevices[association];
+            info.targetChannelIndex = FlatAssociations::decodeChannel( flat.targetChannels[association] );
+
+            result.emplace_back( info );
+        }
+    }
+
+    return result;
+}
+
+SourceModel::SourceModel(const DevicesModel& model) :
+    BaseSourceModel(model),
+    m_associationReferences(createAssociationReferences(model)) {
+}
+
+SourceModel::SourceModel(const DevicesModel& model, std::vector<PackedAssociationInfo> associationReferences) :
+    BaseSourceModel(model),
+    m_associationReferences(std::move(associationReferences)) {
+}
+
+size_t SourceModel::getAssociationsCount() const {
+    return m_associationReferences.size();
+}
+
+AssociationInfo SourceModel::getAssociation(size_t row) const {
+    return m_associationReferences[row].unpack();
+}
+
+void SourceModel::copyRows(size_t firstRow, size_t count, PackedAssociationInfo* rows) const {
+    std::copy_n( m_associationReferences.begin() + firstRow, count, rows );
+}
+
+bool SourceModel::findTargetRows(size_t targetDeviceIndex, std::optional<std::optional<size_t>> targetChannelIndex, std::vector<size_t>& rows) const {
+    const auto& model = getDevicesModel();
+    const auto sources = targetChannelIndex ? model.getIncomingAssociations( targetDeviceIndex, *targetChannelIndex ) :
+                                              model.getIncomingAssociations( targetDeviceIndex );
+
+    for ( const auto& source : sources ) {
+        const auto [first, count] = getGroupRows( source.deviceIndex, source.channelIndex, source.groupIndex );
+
+        for ( size_t row = first; row < first + count; ++row ) {
+            const auto reference = m_associationReferences[row].unpack();
+
+            if ( reference.targetDeviceIndex == targetDeviceIndex && reference.targetChannelIndex == source.targetChannelIndex )
+                rows.push_back( row );
+        }
+    }
+
+    return true;
+}
+
+bool SourceModel::storesRows() const {
+    return true;
+}
+
+void SourceModel::appendGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result) const {
+    appendGroupReferences( getDevicesModel(), deviceIndex, channelIndex, groupIndex, result );
+}
+
+std::pair<size_t, size_t> SourceModel::getGroupRows(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const {
+    const auto key = PackedAssociationInfo( AssociationInfo{ deviceIndex, channelIndex, groupIndex, 0, {} } ).getSourceKey();
+
+    auto range = std::equal_range( m_associationReferences.begin(), m_associationReferences.end(), key, PackedSourceLess() );
+
+    return { range.first - m_associationReferences.begin(), range.second - range.first };
+}
+
+void SourceModel::setGroupReferences(size_t, size_t, size_t, size_t firstRow, size_t rowsCount, std::vector<AssociationInfo> references) {
+    auto it = m_associationReferences.erase( m_associationReferences.begin() + firstRow,
+                                             m_associationReferences.begin() + firstRow + rowsCount );
+    std::vector<PackedAssociationInfo> packedReferences( references.begin(), references.end() );
+    m_associationReferences.insert( it, packedReferences.begin(), packedReferences.end() );
+}
+
+void HintSourceModel::appendGroupReferences(const DevicesModel& model, size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result) {
+    const auto& group = model.getDevices()[deviceIndex].channelsToGroups[channelIndex][groupIndex];
+
+    if ( group.associations.size() >= group.maxAssociationsNumber )
+        return;
+
+    std::set< std::pair< size_t, std::optional<size_t> > > existingAssociations;
+
+    for ( auto& association : group.associations ) {
+        existingAssociations.emplace( association.deviceIndex, association.channelIndex );
+    }
+
+    AssociationInfo reference = {};
+    reference.deviceIndex = deviceIndex;
+    reference.channelIndex = channelIndex;
+    reference.groupIndex = groupIndex;
+
+    reference.targetDeviceIndex = 0;
+    for ( const auto& targetDevice : model.getDevices() ) {
+        if ( reference.deviceIndex != reference.targetDeviceIndex ) {
+            reference.targetChannelIndex = {};
+
+            auto addAssociationReference = [&]() {
+                if ( existingAssociations.find( std::make_pair( reference.targetDeviceIndex, reference.targetChannelIndex ) ) == existingAssociations.end() ) {
+                    result.push_back(reference);
+                }
+            };
+
+            addAssociationReference();
+
+            for ( reference.targetChannelIndex = 0;
+                  *reference.targetChannelIndex < targetDevice.channelsToGroups.size();
+                  ++(*reference.targetChannelIndex) ) {
+                addAssociationReference();
+            }
+        }
+
+        ++reference.targetDeviceIndex;
+    }
+}
+
+HintSourceModel::Candidates HintSourceModel::createCandidates(const FlatAssociations& flat, size_t minGroupsPerThread) {
+    Candidates result;
+
+    result.deviceSlots.reserve( flat.channelOffsets.size() );
+    for ( size_t deviceIndex = 0; deviceIndex < flat.channelOffsets.size(); ++deviceIndex ) {
+        result.deviceSlots.push_back( deviceIndex + flat.channelOffsets[deviceIndex] );
+    }
+
+    result.groups.resize( flat.getGroupsCount() );
+
+    // groups are independent, so their candidates are counted in parallel, each into its own slot
+    parallelFor( flat.getGroupsCount(), CandidatesChunkSize, minGroupsPerThread, [&](size_t group) {
+        auto& candidates = result.groups[group];
+        candidates.source = PackedAssociationInfo( AssociationInfo{ flat.groupDevices[group], flat.groupChannels[group], flat.groupIndices[group], 0, {} } );
+
+        const size_t firstAssociation = flat.associationOffsets[group];
+
+        updateCandidates( result.deviceSlots, candidates, flat.associationOffsets[group + 1] - firstAssociation, flat.groupMaxAssociations[group], [&](size_t index) {
+            return std::make_pair( size_t( flat.targetDevices[firstAssociation + index] ),
+                                   FlatAssociations::decodeChannel( flat.targetChannels[firstAssociation + index] ) );
+        } );
+    } );
+
+    for ( const auto& candidates : result.groups ) {
+        result.associationsCount += candidates.rowsCount;
+    }
+
+    return result;
+}
+
+HintSourceModel::HintSourceModel(const DevicesModel& model) :
+    HintSourceModel(model, createCandidates(model.getFlatAssociations())) {
+}
+
+HintSourceModel::HintSourceModel(const DevicesModel& model, Candidates candidates) :
+    BaseSourceModel(model),
+    m_deviceSlots(std::move(candidates.deviceSlots)),
+    m_groups(std::move(candidates.groups)) {
+
+    // row offsets follow the group order, so the rows come out the same however the work was split
+    std::vector<size_t> rowsCounts;
+    rowsCounts.reserve( m_groups.size() );
+
+    for ( const auto& groupCandidates : m_groups ) {
+        rowsCounts.push_back( groupCandidates.rowsCount );
+    }
+
+    m_groupRows = PrefixSums( rowsCounts );
+}
+
+size_t HintSourceModel::getAssociationsCount() const {
+    return m_groupRows.getTotal();
+}
+
+AssociationInfo HintSourceModel::getAssociation(size_t row) const {
+    const size_t group = m_groupRows.find( row );
+    const auto& candidates = m_groups[group];
+
+    size_t slot = row - m_groupRows.getOffset( group );
+    for ( auto excludedSlot : candidates.excludedSlots ) {
+        if ( excludedSlot > slot )
+            break;
+
+        ++slot;
+    }
+
+    auto deviceIt = std::upper_bound( m_deviceSlots.begin(), m_deviceSlots.end(), slot ) - 1;
+    const size_t slotInDevice = slot - *deviceIt;
+
+    AssociationInfo info = candidates.source.unpack();
+    info.targetDeviceIndex = deviceIt - m_deviceSlots.begin();
+
+    if ( slotInDevice > 0 )
+        info.targetChannelIndex = slotInDevice - 1;
+
+    return info;
+}
+
+void HintSourceModel::copyRows(size_t firstRow, size_t count, PackedAssociationInfo* rows) const {
+    if ( count == 0 )
+        return;
+
+    const size_t group = m_groupRows.find( firstRow );
+    auto groupIt = m_groups.begin() + group;
+
+    size_t written = 0;
+    size_t candidate = firstRow - m_groupRows.getOffset( group );
+
+    for ( ; written < count; ++groupIt, candidate = 0 ) {
+        const auto& candidates = *groupIt;
+        if ( candidate >= candidates.rowsCount )
+            continue;
+
+        // the slot of the first candidate as in getAssociation(), then slots follow one by one
+        size_t slot = candidate;
+        for ( auto excludedSlot : candidates.excludedSlots ) {
+            if ( excludedSlot > slot )
+                break;
+
+            ++slot;
+        }
+
+        auto excludedIt = std::lower_bound( candidates.excludedSlots.begin(), candidates.excludedSlots.end(), slot );
+        auto deviceIt = std::upper_bound( m_deviceSlots.begin(), m_deviceSlots.end(), slot ) - 1;
+
+        AssociationInfo info = candidates.source.unpack();
+
+        for ( ; candidate < candidates.rowsCount && written < count; ++slot ) {
+            if ( excludedIt != candidates.excludedSlots.end() && *excludedIt == slot ) {
+                ++excludedIt;
+                continue;
+            }
+
+            while ( slot >= *( deviceIt + 1 ) ) {
+                ++deviceIt;
+            }
+
+            const size_t slotInDevice = slot - *deviceIt;
+
+            info.targetDeviceIndex = deviceIt - m_deviceSlots.begin();
+            info.targetChannelIndex = slotInDevice > 0 ? std::optional<size_t>( slotInDevice - 1 ) : std::optional<size_t>();
+
+            rows[written++] = PackedAssociationInfo( info );
+            ++candidate;
+        }
+    }
+}
+
+void HintSourceModel::appendGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result) const {
+    appendGroupReferences( getDevicesModel(), deviceIndex, channelIndex, groupIndex, result );
+}
+
+std::pair<size_t, size_t> HintSourceModel::getGroupRows(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const {
+    const size_t group = findGroup( deviceIndex, channelIndex, groupIndex ) - m_groups.data();
+
+    return { m_groupRows.getOffset( group ), m_groups[group].rowsCount };
+}
+
+void HintSourceModel::setGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex, size_t, size_t, std::vector<AssociationInfo>) {
+    const size_t group = findGroup( deviceIndex, channelIndex, groupIndex ) - m_groups.data();
+
+    updateCandidates( m_groups[group] );
+    m_groupRows.setCount( group, m_groups[group].rowsCount );
+}
+
+const HintSourceModel::GroupCandidates* HintSourceModel::findGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const {
+    const auto key = PackedAssociationInfo( AssociationInfo{ deviceIndex, channelIndex, groupIndex, 0, {} } ).getSourceKey();
+
+    return &*std::lower_bound( m_groups.begin(), m_groups.end(), key, [](const GroupCandidates& candidates, uint32_t key) {
+        return candidates.source.getSourceKey() < key;
+    } );
+}
+
+void HintSourceModel::updateCandidates(GroupCandidates& candidates) const {
+    const auto source = candidates.source.unpack();
+    const auto& group = getDevicesModel().getDevices()[source.deviceIndex].channelsToGroups[source.channelIndex][source.groupIndex];
+
+    updateCandidates( m_deviceSlots, candidates, group.associations.size(), group.maxAssociationsNumber, [&group](size_t index) {
+        return std::make_pair( group.associations[index].deviceIndex, group.associations[index].channelIndex );
+    } );
+}
+
+AssociationListProxyModel::AssociationListProxyModel(BaseSourceModel* sourceModel) {
+    // connected before setSourceModel() so the cached rows are dropped before the proxy re-filters
+    auto invalidateIndex = [this]() {
+        m_indexValid = false;
+        m_scansSinceChange = 0;
+        m_acceptedRowsValid = false;
+    };
+
+    connect( sourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this, invalidateIndex );
+    connect( sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, invalidateIndex );
+    connect( sourceModel, &QAbstractItemModel::dataChanged, this, invalidateIndex );
+    connect( sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, invalidateIndex );
+
+    setSourceModel( sourceModel );
+}
+
+void AssociationListProxyModel::setFilter(FilterInfo filterInfo) {
+    m_filterInfo = std::move(filterInfo);
+    m_acceptedRowsValid = false;
+
+    auto model = static_cast< BaseSourceModel* >( sourceModel() );
+    m_filter = m_filterInfo.isEmpty() ? AssociationFilter() : AssociationFilter( model->getDevicesModel(), m_filterInfo );
+
+    if ( !m_filterInfo.isEmpty() ) {
+        std::vector<size_t> targetRows;
+
+        // the rows of every target device through the reverse index, if the model has one
+        auto findTargetRows = [&]() {
+            if ( m_filterInfo.targetDeviceIndices.isEmpty() )
+                return false;
+
+            std::optional<std::optional<size_t>> targetChannelIndex;
+            if ( m_filterInfo.targetChannels.getSize() == 1 )
+                targetChannelIndex = FilterInfo::decodeTargetChannel( m_filterInfo.targetChannels.getFirst() );
+
+            bool found = true;
+            m_filterInfo.targetDeviceIndices.forEach( [&](size_t targetDeviceIndex) {
+                found = found && model->findTargetRows( targetDeviceIndex, targetChannelIndex, targetRows );
+            } );
+
+            // the rows are read in order, once each
+            std::sort( targetRows.begin(), targetRows.end() );
+            targetRows.erase( std::unique( targetRows.begin(), targetRows.end() ), targetRows.end() );
+
+            return found;
+        };
+
+        if ( findTargetRows() ) {
+            m_acceptedRows.assign( ( model->getAssociationsCount() + 63 ) / 64, 0 );
+
+            m_filter.visit( [&](auto matches) {
+                for ( auto row : targetRows ) {
+                    if ( matches( model->getAssociation( row ) ) )
+                        setRow( m_acceptedRows, row );
+                }
+            } );
+        }
+        else if ( !m_indexValid && ( m_scansSinceChange < ScansBeforeIndex || !canIndex() ) ) {
+            m_acceptedRows = AssociationBatchFilter( model->getDevicesModel(), m_filterInfo ).match( model->getAssociationsCount(),
+                [model](size_t firstRow, size_t count, PackedAssociationInfo* rows) {
+                    model->copyRows( firstRow, count, rows );
+                } );
+
+            ++m_scansSinceChange;
+        }
+        else {
+            if ( !m_indexValid ) {
+                m_index.build( model->getDevicesModel(), model->getAssociationsCount(), [model](size_t row) {
+                    return model->getAssociation( row );
+                } );
+
+                m_indexValid = true;
+            }
+
+            m_acceptedRows = m_index.match( m_filterInfo );
+        }
+
+        m_acceptedRowsValid = true;
+    }
+
+    invalidate();
+}
+
+bool AssociationListProxyModel::canIndex() const {
+    auto model = static_cast< BaseSourceModel* >( sourceModel() );
+
+    return model->storesRows() && model->getAssociationsCount() <= AssociationFilterIndex::MaxRowsCount;
+}
+
+bool AssociationListProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &) const {
+    if ( m_filterInfo.isEmpty() )
+        return true;
+
+    if ( m_acceptedRowsValid )
+        return testRow( m_acceptedRows, static_cast<size_t>( sourceRow ) );
+
+    return m_filter( static_cast< BaseSourceModel* >( sourceModel() )->getAssociation( sourceRow ) );
+}
+
+RankedAssociationsProxyModel::RankedAssociationsProxyModel(AssociationListProxyModel* sourceModel) {
+    setSourceModel( sourceModel );
+
+    auto beginReset = [this]() {
+        beginRankingReset();
+    };
+
+    auto endReset = [this]() {
+        endRankingReset();
+    };
+
+    connect( sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, beginReset );
+    connect( sourceModel, &QAbstractItemModel::modelReset, this, endReset );
+    connect( sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, beginReset );
+    connect( sourceModel, &QAbstractItemModel::layoutChanged, this, endReset );
+    connect( sourceModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex&, int first, int last) {
+        onRowsInserted( first, last );
+    } );
+    connect( sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this](const QModelIndex&, int first, int last) {
+        onRowsAboutToBeRemoved( first, last );
+    } );
+    connect( sourceModel, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex&, int first, int last) {
+        onRowsRemoved( first, last );
+    } );
+    connect( sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+        onDataChanged( topLeft.row(), bottomRight.row() );
+    } );
+}
+
+QModelIndex RankedAssociationsProxyModel::index(int row, int column, const QModelIndex& parent) const {
+    if ( parent.isValid() || row < 0 || static_cast<size_t>( row ) >= m_rankedRows.size() || column != 0 )
+        return {};
+
+    return createIndex( row, column );
+}
+
+QModelIndex RankedAssociationsProxyModel::parent(const QModelIndex&) const {
+    return {};
+}
+
+int RankedAssociationsProxyModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>( m_rankedRows.size() );
+}
+
+int RankedAssociationsProxyModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : 1;
+}
+
+QModelIndex RankedAssociationsProxyModel::mapToSource(const QModelIndex& proxyIndex) const {
+    if ( !proxyIndex.isValid() )
+        return {};
+
+    return sourceModel()->index( static_cast<int>( m_rankedRows[proxyIndex.row()] ), 0 );
+}
+
+QModelIndex RankedAssociationsProxyModel::mapFromSource(const QModelIndex& sourceIndex) const {
+    if ( !sourceIndex.isValid() || static_cast<size_t>( sourceIndex.row() ) >= m_proxyRows.size() || m_proxyRows[sourceIndex.row()] < 0 )
+        return {};
+
+    return index( m_proxyRows[sourceIndex.row()], 0 );
+}
+
+QVariant RankedAssociationsProxyModel::data(const QModelIndex& index, int role) const {
+    if ( role == RelevanceRole ) {
+        return index.isValid() ? QVariant( static_cast<int>( m_scores[m_rankedRows[index.row()]] ) ) : QVariant();
+    }
+
+    return QAbstractProxyModel::data( index, role );
+}
+
+bool RankedAssociationsProxyModel::canFetchMore(const QModelIndex& parent) const {
+    if ( parent.isValid() )
+        return false;
+
+    return m_scored ? !m_unrankedRows.empty() : sourceModel()->rowCount() > 0;
+}
+
+void RankedAssociationsProxyModel::fetchMore(const QModelIndex& parent) {
+    if ( parent.isValid() )
+        return;
+
+    if ( !m_scored )
+        scoreRows();
+
+    if ( m_unrankedRows.empty() )
+        return;
+
+    const size_t count = std::min( m_unrankedRows.size(), ChunkSize );
+    auto moreRelevant = [this](uint32_t left, uint32_t right) {
+        return isMoreRelevant( left, right );
+    };
+
+    const auto first = m_unrankedRows.begin();
+    const auto last = m_unrankedRows.begin() + count;
+
+    if ( last != m_unrankedRows.end() )
+        std::nth_element( first, last, m_unrankedRows.end(), moreRelevant );
+
+    std::sort( first, last, moreRelevant );
+
+    const size_t rankedCount = m_rankedRows.size();
+    beginInsertRows( {}, static_cast<int>( rankedCount ), static_cast<int>( rankedCount + count ) - 1 );
+
+    m_rankedRows.insert( m_rankedRows.end(), first, last );
+    m_unrankedRows.erase( first, last );
+    renumberRankedRows( rankedCount );
+
+    endInsertRows();
+}
+
+void RankedAssociationsProxyModel::beginRankingReset() {
+    if ( m_resetting )
+        return;
+
+    m_resetting = true;
+    beginResetModel();
+}
+
+void RankedAssociationsProxyModel::endRankingReset() {
+    if ( !m_resetting )
+        return;
+
+    m_rankedRows.clear();
+    m_unrankedRows.clear();
+    m_scores.clear();
+    m_proxyRows.clear();
+    m_scored = false;
+
+    m_resetting = false;
+    endResetModel();
+}
+
+void RankedAssociationsProxyModel::scoreRows() {
+    auto listModel = static_cast<AssociationListProxyModel*>( sourceModel() );
+    const size_t rowsCount = static_cast<size_t>( listModel->rowCount() );
+
+    if ( !m_scorer ) {
+        m_scorer = std::make_unique<AssociationScorer>( static_cast<BaseSourceModel*>( listModel->sourceModel() )->getDevicesModel() );
+    }
+
+    m_unrankedRows.resize( rowsCount );
+    m_scores.resize( rowsCount );
+    m_proxyRows.assign( rowsCount, -1 );
+
+    for ( size_t row = 0; row < rowsCount; ++row ) {
+        m_unrankedRows[row] = static_cast<uint32_t>( row );
+        m_scores[row] = scoreRow( static_cast<int>( row ) );
+    }
+
+    m_scored = true;
+}
+
+uint8_t RankedAssociationsProxyModel::scoreRow(int row) const {
+    auto listModel = static_cast<AssociationListProxyModel*>( sourceModel() );
+    auto model = static_cast<BaseSourceModel*>( listModel->sourceModel() );
+
+    const auto sourceRow = listModel->mapToSource( listModel->index( row, 0 ) ).row();
+    return m_scorer->score( model->getAssociation( static_cast<size_t>( sourceRow ) ) );
+}
+
+bool RankedAssociationsProxyModel::isMoreRelevant(uint32_t left, uint32_t right) const {
+    return m_scores[left] != m_scores[right] ? m_scores[left] > m_scores[right] : left < right;
+}
+
+void RankedAssociationsProxyModel::onRowsInserted(int first, int last) {
+    if ( !m_scored || m_resetting )
+        return;
+
+    const auto count = static_cast<uint32_t>( last - first + 1 );
+
+    // shifting keeps the order of equal scores, so the ranked rows stay sorted
+    auto shift = [&](std::vector<uint32_t>& rows) {
+        for ( auto& row : rows ) {
+            if ( row >= static_cast<uint32_t>( first ) )
+                row += count;
+        }
+    };
+
+    shift( m_rankedRows );
+    shift( m_unrankedRows );
+
+    m_scores.insert( m_scores.begin() + first, count, 0 );
+    m_proxyRows.insert( m_proxyRows.begin() + first, count, -1 );
+
+    for ( int row = first; row <= last; ++row ) {
+        m_scores[row] = scoreRow( row );
+    }
+
+    for ( int row = first; row <= last; ++row ) {
+        placeRow( static_cast<uint32_t>( row ) );
+    }
+}
+
+void RankedAssociationsProxyModel::onRowsAboutToBeRemoved(int first, int last) {
+    if ( !m_scored || m_resetting )
+        return;
+
+    // shown rows go while the source still has them, the rest is dropped in onRowsRemoved()
+    for ( int row = first; row <= last; ++row ) {
+        if ( m_proxyRows[row] >= 0 )
+            takeRow( static_cast<uint32_t>( row ) );
+    }
+}
+
+void RankedAssociationsProxyModel::onRowsRemoved(int first, int last) {
+    if ( !m_scored || m_resetting )
+        return;
+
+    const auto count = static_cast<uint32_t>( last - first + 1 );
+
+    m_unrankedRows.erase( std::remove_if( m_unrankedRows.begin(), m_unrankedRows.end(), [&](uint32_t row) {
+        return row >= static_cast<uint32_t>( first ) && row <= static_cast<uint32_t>( last );
+    } ), m_unrankedRows.end() );
+
+    auto shift = [&](std::vector<uint32_t>& rows) {
+        for ( auto& row : rows ) {
+            if ( row > static_cast<uint32_t>( last ) )
+                row -= count;
+        }
+    };
+
+    shift( m_rankedRows );
+    shift( m_unrankedRows );
+
+    m_scores.erase( m_scores.begin() + first, m_scores.begin() + last + 1 );
+    m_proxyRows.erase( m_proxyRows.begin() + first, m_proxyRows.begin() + last + 1 );
+}
+
+void RankedAssociationsProxyModel::onDataChanged(int first, int last) {
+    if ( !m_scored || m_resetting || first < 0 )
+        return;
+
+    std::vector<std::pair<uint32_t, uint8_t>> movedRows;
+
+    for ( int row = first; row <= last; ++row ) {
+        const auto score = scoreRow( row );
+
+        if ( score != m_scores[row] ) {
+            movedRows.emplace_back( static_cast<uint32_t>( row ), score );
+        }
+        else if ( m_proxyRows[row] >= 0 ) {
+            const auto changedIndex = index( m_proxyRows[row], 0 );
+            emit dataChanged( changedIndex, changedIndex );
+        }
+    }
+
+    // a moved row is taken out under its old score and placed again under the new one
+    for ( const auto& [row, score] : movedRows ) {
+        takeRow( row );
+        m_scores[row] = score;
+        placeRow( row );
+    }
+}
+
+void RankedAssociationsProxyModel::placeRow(uint32_t sourceRow) {
+    if ( m_rankedRows.empty() || ( !m_unrankedRows.empty() && !isMoreRelevant( sourceRow, m_rankedRows.back() ) ) ) {
+        m_unrankedRows.push_back( sourceRow );
+        return;
+    }
+
+    const auto position = std::lower_bound( m_rankedRows.begin(), m_rankedRows.end(), sourceRow, [this](uint32_t left, uint32_t right) {
+        return isMoreRelevant( left, right );
+    } ) - m_rankedRows.begin();
+
+    beginInsertRows( {}, static_cast<int>( position ), static_cast<int>( position ) );
+
+    m_rankedRows.insert( m_rankedRows.begin() + position, sourceRow );
+    renumberRankedRows( position );
+
+    endInsertRows();
+}
+
+void RankedAssociationsProxyModel::takeRow(uint32_t sourceRow) {
+    const int proxyRow = m_proxyRows[sourceRow];
+
+    if ( proxyRow < 0 ) {
+        m_unrankedRows.erase( std::find( m_unrankedRows.begin(), m_unrankedRows.end(), sourceRow ) );
+        return;
+    }
+
+    beginRemoveRows( {}, proxyRow, proxyRow );
+
+    m_rankedRows.erase( m_rankedRows.begin() + proxyRow );
+    m_proxyRows[sourceRow] = -1;
+    renumberRankedRows( static_cast<size_t>( proxyRow ) );
+
+    endRemoveRows();
+}
+
+void RankedAssociationsProxyModel::renumberRankedRows(size_t firstRow) {
+    for ( size_t row = firstRow; row < m_rankedRows.size(); ++row ) {
+        m_proxyRows[m_rankedRows[row]] = static_cast<int>( row );
+    }
+}
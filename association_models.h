@@ -0,0 +1,327 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QAbstractProxyModel>
+#include <QSortFilterProxyModel>
+#include <QString>
+
+#include "association_info.h"
+#include "association_batch_filter.h"
+#include "association_filter.h"
+#include "association_filter_index.h"
+#include "association_ranking.h"
+#include "devices_model.h"
+#include "flat_associations.h"
+#include "prefix_sums.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+QString associationToString(const DevicesModel& model, const AssociationInfo& associationInfo);
+
+// Rendered row texts per source device. Devices never change in place: any device change rebuilds the
+// source models, and a cache with them, so texts are never stale.
+class AssociationTextCache {
+public:
+    explicit AssociationTextCache(size_t capacity = 1 << 16);
+
+    const QString& getText(const DevicesModel& model, const AssociationInfo& info);
+
+    void clear();
+
+    size_t getHits() const;
+
+    size_t getMisses() const;
+
+private:
+    size_t m_capacity;
+    size_t m_size = 0;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+    std::vector<std::unordered_map<PackedAssociationInfo, QString, PackedAssociationInfoHash>> m_texts;
+};
+
+class BaseSourceModel : public QAbstractListModel {
+public:
+
+    BaseSourceModel(const DevicesModel& model);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    int rowCount(const QModelIndex &parent) const override;
+
+    virtual size_t getAssociationsCount() const = 0;
+
+    virtual AssociationInfo getAssociation(size_t row) const = 0;
+
+    // Rows [firstRow, firstRow + count) packed into rows, for passes that read them in batches.
+    virtual void copyRows(size_t firstRow, size_t count, PackedAssociationInfo* rows) const;
+
+    // Appends the rows targeting the device (and channel) without a pass over the model, unsorted, so that
+    // the rows of several devices are sorted once by the caller. Returns false when the model has no such lookup.
+    virtual bool findTargetRows(size_t targetDeviceIndex, std::optional<std::optional<size_t>> targetChannelIndex, std::vector<size_t>& rows) const;
+
+    // Whether the rows are stored one by one, so an index over them costs about as much memory as the rows.
+    // Lists computed on demand are filtered by scanning instead.
+    virtual bool storesRows() const;
+
+    const DevicesModel& getDevicesModel() const;
+
+    const AssociationTextCache& getTextCache() const;
+
+    // Rows of one group are contiguous, so a change of the group is applied as a single remove/insert
+    // of the differing middle part plus dataChanged for the rows that were replaced in place.
+    void updateGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex);
+
+protected:
+    virtual void appendGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result) const = 0;
+
+    virtual std::pair<size_t, size_t> getGroupRows(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const = 0;
+
+    virtual void setGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex,
+                                    size_t firstRow, size_t rowsCount, std::vector<AssociationInfo> references) = 0;
+
+private:
+    const DevicesModel& m_model;
+    mutable AssociationTextCache m_textCache;
+};
+
+
+class SourceModel : public BaseSourceModel {
+public:
+
+    static void appendGroupReferences(const DevicesModel& model, size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result);
+
+    static std::vector<PackedAssociationInfo> createAssociationReferences(const DevicesModel& model);
+
+    static std::vector<PackedAssociationInfo> createAssociationReferences(const FlatAssociations& flat);
+
+    SourceModel(const DevicesModel& model);
+
+    // Takes rows built beforehand, e.g. on a worker thread, from the current state of the model.
+    SourceModel(const DevicesModel& model, std::vector<PackedAssociationInfo> associationReferences);
+
+    size_t getAssociationsCount() const override;
+
+    AssociationInfo getAssociation(size_t row) const override;
+
+    void copyRows(size_t firstRow, size_t count, PackedAssociationInfo* rows) const override;
+
+    bool findTargetRows(size_t targetDeviceIndex, std::optional<std::optional<size_t>> targetChannelIndex, std::vector<size_t>& rows) const override;
+
+    bool storesRows() const override;
+
+protected:
+    void appendGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result) const override;
+
+    std::pair<size_t, size_t> getGroupRows(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const override;
+
+    void setGroupReferences(size_t, size_t, size_t, size_t firstRow, size_t rowsCount, std::vector<AssociationInfo> references) override;
+
+private:
+    std::vector<PackedAssociationInfo> m_associationReferences;
+};
+
+// Candidates are never materialized. Every (target device, target channel) pair is a "slot": the whole
+// node first, then its channels. A group's candidates are all slots except its own device and already
+// associated targets, so a row maps to a candidate arithmetically and the model only stores one small
+// entry per association group. Group row counts are kept as prefix sums, so editing a group does not
+// shift the first rows of all the groups after it.
+class HintSourceModel : public BaseSourceModel {
+public:
+
+    static void appendGroupReferences(const DevicesModel& model, size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result);
+
+    struct GroupCandidates {
+        PackedAssociationInfo source;
+        size_t rowsCount = 0;
+        std::vector<uint32_t> excludedSlots;
+    };
+
+    struct Candidates {
+        std::vector<size_t> deviceSlots;
+        std::vector<GroupCandidates> groups;
+        size_t associationsCount = 0;
+    };
+
+    // groups a thread started for counting the candidates gets at least: a group takes a fraction of a microsecond
+    // and a thread tens of microseconds to start and join, see hint_candidates_* in the benchmark
+    static constexpr size_t MinCandidatesGroupsPerThread = 4096;
+
+    // Reads nothing but the flat layout, so it may run on a worker thread.
+    static Candidates createCandidates(const FlatAssociations& flat, size_t minGroupsPerThread = MinCandidatesGroupsPerThread);
+
+    HintSourceModel(const DevicesModel& model);
+
+    // Takes candidates built beforehand, e.g. on a worker thread, from the current state of the model.
+    HintSourceModel(const DevicesModel& model, Candidates candidates);
+
+    size_t getAssociationsCount() const override;
+
+    AssociationInfo getAssociation(size_t row) const override;
+
+    // Walks the slots of consecutive groups instead of locating every row on its own.
+    void copyRows(size_t firstRow, size_t count, PackedAssociationInfo* rows) const override;
+
+protected:
+    void appendGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex, std::vector<AssociationInfo>& result) const override;
+
+    std::pair<size_t, size_t> getGroupRows(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const override;
+
+    void setGroupReferences(size_t deviceIndex, size_t channelIndex, size_t groupIndex, size_t, size_t, std::vector<AssociationInfo>) override;
+
+private:
+    // groups a worker thread claims at once while the candidates are counted
+    static constexpr size_t CandidatesChunkSize = 1024;
+
+    const GroupCandidates* findGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const;
+
+    void updateCandidates(GroupCandidates& candidates) const;
+
+    // targetAt(index) returns the (target device, target channel) of the group's association number index
+    template<typename TargetAccessor>
+    static void updateCandidates(const std::vector<size_t>& deviceSlots, GroupCandidates& candidates, size_t associationsCount, size_t maxAssociationsNumber, TargetAccessor targetAt) {
+        candidates.excludedSlots.clear();
+
+        if ( associationsCount >= maxAssociationsNumber ) {
+            candidates.rowsCount = 0;
+            return;
+        }
+
+        const size_t deviceIndex = candidates.source.getDeviceIndex();
+
+        for ( size_t slot = deviceSlots[deviceIndex]; slot < deviceSlots[deviceIndex + 1]; ++slot ) {
+            candidates.excludedSlots.push_back( static_cast<uint32_t>( slot ) );
+        }
+
+        for ( size_t index = 0; index < associationsCount; ++index ) {
+            const auto [targetDeviceIndex, targetChannelIndex] = targetAt( index );
+
+            if ( targetDeviceIndex + 1 >= deviceSlots.size() )
+                continue;
+
+            const size_t channelsCount = deviceSlots[targetDeviceIndex + 1] - deviceSlots[targetDeviceIndex] - 1;
+            if ( targetChannelIndex && *targetChannelIndex >= channelsCount )
+                continue;
+
+            candidates.excludedSlots.push_back( static_cast<uint32_t>( deviceSlots[targetDeviceIndex] + ( targetChannelIndex ? *targetChannelIndex + 1 : 0 ) ) );
+        }
+
+        std::sort( candidates.excludedSlots.begin(), candidates.excludedSlots.end() );
+        candidates.excludedSlots.erase( std::unique( candidates.excludedSlots.begin(), candidates.excludedSlots.end() ), candidates.excludedSlots.end() );
+
+        candidates.rowsCount = deviceSlots.back() - candidates.excludedSlots.size();
+    }
+
+private:
+    std::vector<size_t> m_deviceSlots;
+    std::vector<GroupCandidates> m_groups;
+    // rows of m_groups[i], in the same order
+    PrefixSums m_groupRows;
+};
+
+class AssociationListProxyModel : public QSortFilterProxyModel {
+public:
+    AssociationListProxyModel(BaseSourceModel* sourceModel);
+
+    void setFilter(FilterInfo filterInfo);
+
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &) const override;
+
+private:
+
+    FilterInfo m_filterInfo;
+    AssociationFilter m_filter;
+
+    // The first full pass over unchanged rows runs the batch filter; from the second on stored rows are
+    // indexed, as filters are being refined and intersecting posting lists beats scanning again. Rows of
+    // lists computed on demand (and lists too long for the index) are always scanned: their postings would
+    // take far more memory than the list itself.
+    static constexpr size_t ScansBeforeIndex = 1;
+
+    bool canIndex() const;
+
+    AssociationFilterIndex m_index;
+    bool m_indexValid = false;
+    size_t m_scansSinceChange = 0;
+
+    RowBitmap m_acceptedRows;
+    bool m_acceptedRowsValid = false;
+};
+
+// Shows the rows of an AssociationListProxyModel ordered by AssociationScorer, most relevant first and equal scores
+// in list order. Only a prefix is ranked: each fetchMore() selects the next chunk with nth_element and sorts just
+// that chunk, and views fetch more as they are scrolled to the end. Inserted, removed and changed source rows are
+// scored one by one and put in or taken out of the ranked prefix, so selection and scrolling survive edits; only
+// a reset or a layout change of the source, e.g. a new filter, drops the ranking.
+class RankedAssociationsProxyModel : public QAbstractProxyModel {
+public:
+    // the score of the row, for views that show less relevant rows differently
+    static constexpr int RelevanceRole = Qt::UserRole + 1;
+
+    static constexpr size_t ChunkSize = 256;
+
+    RankedAssociationsProxyModel(AssociationListProxyModel* sourceModel);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = {}) const override;
+
+    QModelIndex parent(const QModelIndex& child) const override;
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+
+    int columnCount(const QModelIndex& parent = {}) const override;
+
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+
+    QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    void beginRankingReset();
+
+    void endRankingReset();
+
+    void scoreRows();
+
+    uint8_t scoreRow(int row) const;
+
+    bool isMoreRelevant(uint32_t left, uint32_t right) const;
+
+    void onRowsInserted(int first, int last);
+
+    void onRowsAboutToBeRemoved(int first, int last);
+
+    void onRowsRemoved(int first, int last);
+
+    void onDataChanged(int first, int last);
+
+    // puts a scored source row that is not shown into the ranked prefix if it outranks the rest, or after it
+    void placeRow(uint32_t sourceRow);
+
+    // takes a source row out of the ranked prefix, or out of the rows after it
+    void takeRow(uint32_t sourceRow);
+
+    void renumberRankedRows(size_t firstRow);
+
+private:
+    // source rows: the shown ones in their final order, each of them more relevant than any of the rest
+    std::vector<uint32_t> m_rankedRows;
+    std::vector<uint32_t> m_unrankedRows;
+    // by source row
+    std::vector<uint8_t> m_scores;
+    std::vector<int> m_proxyRows;
+
+    // scores do not depend on the associations, so one scorer serves the source models for as long as they live
+    std::unique_ptr<AssociationScorer> m_scorer;
+
+    bool m_scored = false;
+    bool m_resetting = false;
+};
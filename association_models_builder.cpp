@@ -0,0 +1,106 @@
+#include "association_models_builder.h"
+
+AssociationModelsBuilder::AssociationModelsBuilder(QObject* parent) :
+    QObject(parent)
+{
+    m_thread = std::thread( [this]() {
+        run();
+    } );
+}
+
+AssociationModelsBuilder::~AssociationModelsBuilder() {
+    ++m_generation;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stopping = true;
+    }
+
+    m_requestChanged.notify_one();
+    m_thread.join();
+}
+
+void AssociationModelsBuilder::start(std::shared_ptr<const FlatAssociations> flat) {
+    const uint64_t generation = ++m_generation;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_pendingFlat = std::move( flat );
+        m_pendingGeneration = generation;
+    }
+
+    m_running = true;
+    m_requestChanged.notify_one();
+}
+
+void AssociationModelsBuilder::cancel() {
+    ++m_generation;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_pendingFlat.reset();
+    }
+
+    m_running = false;
+}
+
+bool AssociationModelsBuilder::isRunning() const {
+    return m_running;
+}
+
+AssociationModelsBuilder::Result AssociationModelsBuilder::takeResult() {
+    return std::move( m_result );
+}
+
+void AssociationModelsBuilder::run() {
+    for ( ;; ) {
+        std::shared_ptr<const FlatAssociations> flat;
+        uint64_t generation = 0;
+
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_requestChanged.wait( lock, [this]() {
+                return m_stopping || m_pendingFlat;
+            } );
+
+            if ( m_stopping )
+                return;
+
+            flat.swap( m_pendingFlat );
+            generation = m_pendingGeneration;
+        }
+
+        // the stages are checked in between, a superseded build stops at the next one
+        if ( isCancelled( generation ) )
+            continue;
+
+        auto result = std::make_shared<Result>();
+        result->associationReferences = SourceModel::createAssociationReferences( *flat );
+
+        if ( isCancelled( generation ) )
+            continue;
+
+        result->candidates = HintSourceModel::createCandidates( *flat );
+
+        if ( isCancelled( generation ) )
+            continue;
+
+        deliver( generation, std::move( result ) );
+    }
+}
+
+bool AssociationModelsBuilder::isCancelled(uint64_t generation) const {
+    return generation != m_generation.load( std::memory_order_relaxed );
+}
+
+void AssociationModelsBuilder::deliver(uint64_t generation, std::shared_ptr<Result> result) {
+    // queued to the GUI thread; a request made after the build finished still wins over this result there
+    QMetaObject::invokeMethod( this, [this, generation, result]() {
+        if ( isCancelled( generation ) )
+            return;
+
+        m_running = false;
+        m_result = std::move( *result );
+        emit finished();
+    }, Qt::QueuedConnection );
+}
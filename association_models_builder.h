@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QObject>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "association_models.h"
+#include "flat_associations.h"
+
+// Builds the rows of the existing and potential association lists on a worker thread from an immutable
+// flat snapshot of the network. Only the latest request matters: a new one cancels the build in progress,
+// and a result that was superseded before it reached the GUI thread is dropped there.
+class AssociationModelsBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result {
+        std::vector<PackedAssociationInfo> associationReferences;
+        HintSourceModel::Candidates candidates;
+    };
+
+    explicit AssociationModelsBuilder(QObject* parent = nullptr);
+    ~AssociationModelsBuilder();
+
+    void start(std::shared_ptr<const FlatAssociations> flat);
+
+    void cancel();
+
+    bool isRunning() const;
+
+    // The result of the latest build, valid after finished().
+    Result takeResult();
+
+signals:
+    void finished();
+
+private:
+    void run();
+
+    bool isCancelled(uint64_t generation) const;
+
+    void deliver(uint64_t generation, std::shared_ptr<Result> result);
+
+private:
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_requestChanged;
+    std::shared_ptr<const FlatAssociations> m_pendingFlat;
+    uint64_t m_pendingGeneration = 0;
+    bool m_stopping = false;
+
+    // bumped by every start() and cancel(), a build gives up as soon as it no longer matches
+    std::atomic<uint64_t> m_generation{ 0 };
+    bool m_running = false;
+
+    Result m_result;
+};
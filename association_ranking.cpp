@@ -0,0 +1,114 @@
+#include "association_ranking.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+std::string toLower(std::string text) {
+    std::transform( text.begin(), text.end(), text.begin(), [](unsigned char c) {
+        return static_cast<char>( std::tolower( c ) );
+    } );
+
+    return text;
+}
+
+void sortUnique(std::vector<uint32_t>& ids) {
+    std::sort( ids.begin(), ids.end() );
+    ids.erase( std::unique( ids.begin(), ids.end() ), ids.end() );
+}
+
+}
+
+AssociationScorer::AssociationScorer(const DevicesModel& model) :
+    m_flat(model.getFlatAssociationsSnapshot())
+{
+    const auto& devices = model.getDevices();
+
+    m_hubDevices.reserve( devices.size() );
+    m_deviceSlots.reserve( devices.size() + 1 );
+    m_deviceSlots.push_back( 0 );
+
+    for ( const auto& device : devices ) {
+        m_hubDevices.push_back( device.nodeId == HubNodeId );
+        m_deviceSlots.push_back( m_deviceSlots.back() + 1 + device.channelsToGroups.size() );
+    }
+
+    m_slotCommandClasses.resize( m_deviceSlots.back() );
+
+    for ( size_t deviceIndex = 0; deviceIndex < devices.size(); ++deviceIndex ) {
+        auto addItems = [&](const std::vector<DevicesModel::Item>& items) {
+            for ( const auto& item : items ) {
+                for ( const auto& reference : item.references ) {
+                    addCommandClass( deviceIndex, reference.channelIndex, reference.cc );
+                }
+            }
+        };
+
+        addItems( devices[deviceIndex].items );
+
+        for ( const auto& child : devices[deviceIndex].children ) {
+            addItems( child.items );
+        }
+    }
+
+    for ( auto& commandClasses : m_slotCommandClasses ) {
+        sortUnique( commandClasses );
+    }
+
+    m_groupProfiles.resize( m_flat->getGroupsCount() );
+    m_lifelineGroups.resize( m_flat->getGroupsCount() );
+
+    for ( size_t group = 0; group < m_flat->getGroupsCount(); ++group ) {
+        const auto& associationGroup = devices[m_flat->groupDevices[group]].channelsToGroups[m_flat->groupChannels[group]][m_flat->groupIndices[group]];
+        const auto profile = toLower( associationGroup.profile );
+
+        for ( size_t start = 0; start <= profile.size(); ) {
+            const size_t end = std::min( profile.find( ':', start ), profile.size() );
+
+            if ( end > start )
+                m_groupProfiles[group].push_back( internToken( profile.substr( start, end - start ) ) );
+
+            start = end + 1;
+        }
+
+        sortUnique( m_groupProfiles[group] );
+        m_lifelineGroups[group] = toLower( associationGroup.name ) == "lifeline";
+    }
+}
+
+uint8_t AssociationScorer::score(const AssociationInfo& info) const {
+    const size_t group = m_flat->getGroupId( info.deviceIndex, info.channelIndex, info.groupIndex );
+    uint8_t result = 0;
+
+    if ( !info.targetChannelIndex )
+        result += WholeNodeBonus;
+
+    if ( m_lifelineGroups[group] && m_hubDevices[info.targetDeviceIndex] )
+        result += LifelineToHubBonus;
+
+    const auto& commandClasses = m_slotCommandClasses[m_deviceSlots[info.targetDeviceIndex] + ( info.targetChannelIndex ? *info.targetChannelIndex + 1 : 0 )];
+
+    for ( auto token : m_groupProfiles[group] ) {
+        if ( std::binary_search( commandClasses.begin(), commandClasses.end(), token ) ) {
+            result += ProfileMatchBonus;
+            break;
+        }
+    }
+
+    return result;
+}
+
+uint32_t AssociationScorer::internToken(const std::string& token) {
+    return m_tokenIds.emplace( token, static_cast<uint32_t>( m_tokenIds.size() ) ).first->second;
+}
+
+void AssociationScorer::addCommandClass(size_t deviceIndex, size_t channelIndex, const std::string& cc) {
+    const auto token = internToken( toLower( cc ) );
+
+    // the whole node offers the command classes of all its channels
+    m_slotCommandClasses[m_deviceSlots[deviceIndex]].push_back( token );
+
+    if ( channelIndex + 1 < m_deviceSlots[deviceIndex + 1] - m_deviceSlots[deviceIndex] )
+        m_slotCommandClasses[m_deviceSlots[deviceIndex] + 1 + channelIndex].push_back( token );
+}
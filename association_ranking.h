@@ -0,0 +1,53 @@
+#pragma once
+
+#include "association_info.h"
+#include "devices_model.h"
+#include "flat_associations.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Relevance of a potential association, higher first. The score is a sum of independent bonuses,
+// so candidates with the same features tie and keep their model order.
+class AssociationScorer
+{
+public:
+    // the controller every device reports to through its Lifeline group
+    static constexpr size_t HubNodeId = 1;
+
+    enum Bonus : uint8_t {
+        WholeNodeBonus = 1,
+        // a token of the group profile ("Siren:Siren") is a command class the target references ("siren")
+        ProfileMatchBonus = 2,
+        LifelineToHubBonus = 4
+    };
+
+    // Candidates below it have no bonus but the whole node one and are shown as less relevant.
+    static constexpr uint8_t RelevantScore = ProfileMatchBonus;
+
+    explicit AssociationScorer(const DevicesModel& model);
+
+    uint8_t score(const AssociationInfo& info) const;
+
+private:
+    uint32_t internToken(const std::string& token);
+
+    void addCommandClass(size_t deviceIndex, size_t channelIndex, const std::string& cc);
+
+private:
+    std::shared_ptr<const FlatAssociations> m_flat;
+    std::unordered_map<std::string, uint32_t> m_tokenIds;
+
+    std::vector<bool> m_hubDevices;
+
+    // the whole node slot of a device is followed by the slots of its channels, as in HintSourceModel
+    std::vector<size_t> m_deviceSlots;
+    std::vector<std::vector<uint32_t>> m_slotCommandClasses;
+
+    // by flat group id
+    std::vector<std::vector<uint32_t>> m_groupProfiles;
+    std::vector<bool> m_lifelineGroups;
+};
@@ -1,4 +1,7 @@
 #include "associations_wizard.h"
+#include "association_models.h"
+#include "association_models_builder.h"
+#include "association_ranking.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -14,19 +17,41 @@
 #include <QMetaType>
 #include <QStyledItemDelegate>
 #include <QSignalBlocker>
+#include <QMessageBox>
+#include <QShowEvent>
 
-#include <sstream>
+#include <algorithm>
 #include <set>
+#include <tuple>
 
 namespace {
 
-struct AssociationInfo {
-    size_t deviceIndex;
-    size_t channelIndex;
-    size_t groupIndex;
-    size_t targetDeviceIndex;
-    std::optional<size_t> targetChannelIndex;
-};
+QPushButton* createAddValueButton(QWidget* parent) {
+    auto button = new QPushButton("+", parent);
+    button->setToolTip("Keep the selected value in the filter and select one more.");
+    button->setFixedWidth(30);
+
+    return button;
+}
+
+QLabel* createExtraValuesLabel(QWidget* parent) {
+    auto label = new QLabel(parent);
+    label->setTextFormat(Qt::RichText);
+    label->hide();
+
+    return label;
+}
+
+void setExtraValues(QLabel* label, const QStringList& values) {
+    label->setVisible( !values.isEmpty() );
+    label->setText( QString("and %1 more (<a href=\"clear\">clear</a>)").arg( values.size() ) );
+    label->setToolTip( values.join("\n") );
+}
+
+void addDeviceHandle(std::vector<DevicesModel::DeviceHandle>& handles, DevicesModel::DeviceHandle handle) {
+    if ( std::find( handles.begin(), handles.end(), handle ) == handles.end() )
+        handles.push_back( handle );
+}
 
 void updateComboModelWithSavingIndex(QComboBox* combo, QStringList stringList) {
     const auto prevIndex = combo->currentIndex();
@@ -57,225 +82,26 @@ class ItemDelegate : public QStyledItemDelegate {
         auto result = QStyledItemDelegate::sizeHint( option, index );
         return QSize( result.width(), result.height() + 16 );
     }
-};
-
-QString associationToString(const DevicesModel& model, const AssociationInfo& associationInfo) {
-    auto& device = model.getDevices()[ associationInfo.deviceIndex ];
-    auto& targetDevice = model.getDevices()[ associationInfo.targetDeviceIndex ];
-
-    std::stringstream stream;
-    stream << "Source: " << device.name << " [node: " << device.nodeId << "; channel: " << associationInfo.channelIndex << "; group: " << device.channelsToGroups[associationInfo.channelIndex][associationInfo.groupIndex].name << "]" <<
-              "\nTarget: " << targetDevice.name << " [node: " << targetDevice.nodeId;
-    if (associationInfo.targetChannelIndex) {
-        stream << "; channel: " << *associationInfo.targetChannelIndex;
-    }
-
-    stream << "]";
-
-    return QString::fromStdString(stream.str());
-}
-
-class BaseSourceModel : public QAbstractListModel {
-public:
-
-    BaseSourceModel(const DevicesModel& model, std::vector<AssociationInfo> references) :
-        m_model(model),
-        m_associationReferences(std::move(references))
-    { }
-
-
-    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override {
-        if ( role == Qt::DisplayRole ) {
-            return associationToString( m_model, m_associationReferences[index.row()] );
-        }
-
-        return {};
-    }
-
-    int rowCount(const QModelIndex &parent) const override {
-        return m_associationReferences.size();
-    }
-
-    const std::vector<AssociationInfo>& getAssociationReferences() const {
-        return m_associationReferences;
-    }
-
-    const DevicesModel& getDevicesModel() const {
-        return m_model;
-    }
-
-private:
-    const DevicesModel& m_model;
-    std::vector<AssociationInfo> m_associationReferences;
-};
-
-
-class SourceModel : public BaseSourceModel {
-public:
-
-    static std::vector<AssociationInfo> createAssociationReferences(const DevicesModel& model) {
-        std::vector<AssociationInfo> result;
-
-        size_t deviceIndex = 0;
-        for ( const auto& device : model.getDevices() ) {
-            size_t channelIndex = 0;
-            for ( const auto& groups : device.channelsToGroups ) {
-                size_t groupIndex = 0;
-                for ( const auto& group : groups ) {
-                    size_t associationIndex = 0;
-                    for ( const auto& association : group.associations ) {
-
-                        AssociationInfo info;
-                        info.deviceIndex = deviceIndex;
-                        info.channelIndex = channelIndex;
-                        info.groupIndex = groupIndex;
-                        info.targetDeviceIndex = association.deviceIndex;
-                        info.targetChannelIndex = association.channelIndex;
-
-                        result.push_back( info );
-
-                        ++associationIndex;
-                    }
-
-                    ++groupIndex;
-                }
-
-                ++channelIndex;
-            }
-            ++deviceIndex;
-        }
-
-        return result;
-    }
-
-
-    SourceModel(const DevicesModel& model) :
-        BaseSourceModel(model, createAssociationReferences(model)) {
-    }
-};
-
-class HintSourceModel : public BaseSourceModel {
-public:
-
-    static std::vector<AssociationInfo> createAssociationReferences(const DevicesModel& model) {
-        std::vector<AssociationInfo> result;
-
-        AssociationInfo reference = {};
-
-        for ( const auto& device : model.getDevices() ) {
-            reference.channelIndex = 0;
-            for ( const auto& groups : device.channelsToGroups ) {
-                reference.groupIndex = 0;
-                for ( const auto& group : groups ) {
-                    if ( group.associations.size() < group.maxAssociationsNumber ) {
-                        std::set< std::pair< size_t, std::optional<size_t> > > existingAssociations;
-
-                        for ( auto& association : group.associations ) {
-                            existingAssociations.emplace( association.deviceIndex, association.channelIndex );
-                        }
 
-                        reference.targetDeviceIndex = 0;
-                        for ( const auto& targetDevice : model.getDevices() ) {
-                            if ( reference.deviceIndex != reference.targetDeviceIndex ) {
-                                reference.targetChannelIndex = {};
+    void initStyleOption(QStyleOptionViewItem* option, const QModelIndex& index) const override {
+        QStyledItemDelegate::initStyleOption( option, index );
 
-                                auto addAssociationReference = [&]() {
-                                    if ( existingAssociations.find( std::make_pair( reference.targetDeviceIndex, reference.targetChannelIndex ) ) == existingAssociations.end() ) {
-                                        result.push_back(reference);
-                                    }
-                                };
-
-                                addAssociationReference();
-
-                                for ( reference.targetChannelIndex = 0;
-                                      *reference.targetChannelIndex < targetDevice.channelsToGroups.size();
-                                      ++(*reference.targetChannelIndex) ) {
-                                    addAssociationReference();
-                                }
-                            }
-
-
-                            ++reference.targetDeviceIndex;
-                        }
-                    }
-                    ++reference.groupIndex;
-                }
-
-                ++reference.channelIndex;
-            }
-            ++reference.deviceIndex;
+        const auto relevance = index.data( RankedAssociationsProxyModel::RelevanceRole );
+        if ( relevance.isValid() && relevance.toInt() < AssociationScorer::RelevantScore ) {
+            option->palette.setColor( QPalette::Text, option->palette.color( QPalette::Disabled, QPalette::Text ) );
         }
-
-        return result;
-    }
-
-    HintSourceModel(const DevicesModel& model) :
-        BaseSourceModel(model, createAssociationReferences(model)) {
-    }
-};
-
-struct FilterInfo {
-    std::optional<size_t> deviceIndex;
-    std::optional<size_t> channelIndex;
-    std::string groupName;
-    std::optional<size_t> targetDeviceIndex;
-    std::optional<std::optional<size_t>> targetChannelIndex;
-};
-
-class AssociationListProxyModel : public QSortFilterProxyModel {
-public:
-    AssociationListProxyModel(BaseSourceModel* sourceModel) {
-        setSourceModel( sourceModel );
-    }
-
-    void setFilter(FilterInfo filterInfo) {
-        m_filterInfo = std::move(filterInfo);
-        invalidate();
-    }
-
-    bool filterAcceptsRow(int sourceRow, const QModelIndex &) const override {
-        auto model = static_cast< BaseSourceModel* >( sourceModel() );
-
-        const auto& associationReference = model->getAssociationReferences()[sourceRow];
-        const auto& devicesModel = model->getDevicesModel();
-
-        const auto& device = devicesModel.getDevices()[ associationReference.deviceIndex ];
-
-        if ( m_filterInfo.deviceIndex && *m_filterInfo.deviceIndex != associationReference.deviceIndex )
-            return false;
-
-        if ( m_filterInfo.channelIndex && *m_filterInfo.channelIndex != associationReference.channelIndex )
-            return false;
-
-        const auto& group = device.channelsToGroups[associationReference.channelIndex][associationReference.groupIndex];
-
-        if ( !m_filterInfo.groupName.empty() && m_filterInfo.groupName != group.name )
-            return false;
-
-        if ( m_filterInfo.targetDeviceIndex && *m_filterInfo.targetDeviceIndex != associationReference.targetDeviceIndex )
-            return false;
-
-        if ( m_filterInfo.targetChannelIndex && *m_filterInfo.targetChannelIndex != associationReference.targetChannelIndex )
-            return false;
-
-        return true;
     }
-
-private:
-
-    FilterInfo m_filterInfo;
 };
 
 }
 
-AssociationsWizard::AssociationsWizard(DevicesModel& model, size_t index, std::optional<size_t> subIndex, QWidget *parent) :
+AssociationsWizard::AssociationsWizard(DevicesModel& model, DevicesModel::DeviceHandle sourceDevice, std::optional<size_t> subIndex, QWidget *parent) :
     QWidget(parent),
-    m_model(model)
+    m_model(model),
+    m_sourceDevice(sourceDevice)
 {
     auto mainLayout = new QVBoxLayout(this);
 
-    const auto& device = model.getDevices()[index];
-
     {
         auto backButton = new QPushButton("< Back To Devices", this);
 
@@ -294,10 +120,25 @@ AssociationsWizard::AssociationsWizard(DevicesModel& model, size_t index, std::o
         m_sourceNodeCombo = new QComboBox(this);
         m_sourceNodeCombo->setModel( new QStringListModel );
 
-        m_sourceNodeCombo->setCurrentIndex( index + 1 );
+        layout->addWidget(m_sourceNodeCombo);
 
+        m_extraSourceDevicesLabel = createExtraValuesLabel(this);
+        layout->addWidget(m_extraSourceDevicesLabel);
 
-        layout->addWidget(m_sourceNodeCombo);
+        auto addButton = createAddValueButton(this);
+        layout->addWidget(addButton);
+
+        connect(addButton, &QPushButton::clicked, this, [this]() {
+            if ( m_sourceNodeCombo->currentIndex() > 0 ) {
+                addDeviceHandle( m_extraSourceDevices, m_model.getDeviceHandle( m_sourceNodeCombo->currentIndex() - 1 ) );
+                updateExtraValuesLabels();
+            }
+        });
+
+        connect(m_extraSourceDevicesLabel, &QLabel::linkActivated, this, [this]() {
+            m_extraSourceDevices.clear();
+            updateExtraValuesLabels();
+        });
 
         mainLayout->addLayout(layout);
     }
@@ -328,12 +169,30 @@ AssociationsWizard::AssociationsWizard(DevicesModel& model, size_t index, std::o
         m_sourceGroupCombo->setModel( new QStringListModel );
         layout->addWidget(m_sourceGroupCombo);
 
+        m_extraSourceGroupsLabel = createExtraValuesLabel(this);
+        layout->addWidget(m_extraSourceGroupsLabel);
+
+        auto addButton = createAddValueButton(this);
+        layout->addWidget(addButton);
+
+        connect(addButton, &QPushButton::clicked, this, [this]() {
+            if ( m_sourceGroupCombo->currentIndex() > 0 && !m_extraSourceGroups.contains( m_sourceGroupCombo->currentText() ) ) {
+                m_extraSourceGroups.append( m_sourceGroupCombo->currentText() );
+                updateExtraValuesLabels();
+            }
+        });
+
+        connect(m_extraSourceGroupsLabel, &QLabel::linkActivated, this, [this]() {
+            m_extraSourceGroups.clear();
+            updateExtraValuesLabels();
+        });
+
         auto groupInfoButton = new QPushButton("Info", this);
         groupInfoButton->setToolTip("Fill source information (source node, channel, group) to see group details.");
         groupInfoButton->setSizePolicy( QSizePolicy::Fixed, groupInfoButton->sizePolicy().verticalPolicy() );
         connect(groupInfoButton, &QPushButton::clicked, this, [this]() {
             if ( m_sourceNodeCombo->currentIndex() > 0 && m_sourceChannelCombo->currentIndex() > 0 && m_sourceGroupCombo->currentIndex() > 0 ) {
-                emit groupsWizardRequested(m_sourceNodeCombo->currentIndex() - 1, m_sourceChannelCombo->currentIndex() - 1, m_sourceGroupCombo->currentIndex() - 1);
+                emit groupsWizardRequested(m_model.getDeviceHandle( m_sourceNodeCombo->currentIndex() - 1 ), m_sourceChannelCombo->currentIndex() - 1, m_sourceGroupCombo->currentIndex() - 1);
             }
         });
 
@@ -358,6 +217,24 @@ AssociationsWizard::AssociationsWizard(DevicesModel& model, size_t index, std::o
         m_targetNodeCombo->setModel( new QStringListModel );
         layout->addWidget(m_targetNodeCombo);
 
+        m_extraTargetDevicesLabel = createExtraValuesLabel(this);
+        layout->addWidget(m_extraTargetDevicesLabel);
+
+        auto addButton = createAddValueButton(this);
+        layout->addWidget(addButton);
+
+        connect(addButton, &QPushButton::clicked, this, [this]() {
+            if ( m_targetNodeCombo->currentIndex() > 0 ) {
+                addDeviceHandle( m_extraTargetDevices, m_model.getDeviceHandle( m_targetNodeCombo->currentIndex() - 1 ) );
+                updateExtraValuesLabels();
+            }
+        });
+
+        connect(m_extraTargetDevicesLabel, &QLabel::linkActivated, this, [this]() {
+            m_extraTargetDevices.clear();
+            updateExtraValuesLabels();
+        });
+
         mainLayout->addLayout(layout);
     }
 
@@ -383,37 +260,22 @@ AssociationsWizard::AssociationsWizard(DevicesModel& model, size_t index, std::o
             viewsLayout->addWidget( new QLabel("Existing Associations", this), 0, 0 );
 
             m_existingAssociationsView = new QListView(this);
-            m_existingAssociationsView->setModel( new AssociationListProxyModel( new SourceModel( m_model ) ) );
             m_existingAssociationsView->setItemDelegate(new ItemDelegate);
+            m_existingAssociationsView->setSelectionMode(QListView::ExtendedSelection);
             m_existingAssociationsView->setToolTip(
 R"(This is a list of existing associations mathing to the chosen filter (source node, source channel, source group, target node, target channel).
-You may remove association by selecting it and pressing the button.)");
+You may remove associations by selecting them and pressing the button.)");
 
             viewsLayout->addWidget(m_existingAssociationsView, 1, 0);
 
-            auto removeAssociationButton = new QPushButton("Remove Selected Association", m_existingAssociationsView);
+            auto removeAssociationButton = new QPushButton("Remove Selected Associations", m_existingAssociationsView);
             //removeAssociationButton->setEnabled(false);
 
             viewsLayout->addWidget(removeAssociationButton, 2, 0);
 
 
             connect(removeAssociationButton, &QPushButton::clicked, this, [=]() {
-                auto selectedIndexes = m_existingAssociationsView->selectionModel()->selectedIndexes();
-                if ( !selectedIndexes.empty() ) {
-                    auto proxyModel = static_cast<QAbstractProxyModel*>( m_existingAssociationsView->model() );
-                    auto sourceIndex = proxyModel->mapToSource(selectedIndexes.front());
-                    auto sourceModel = static_cast<BaseSourceModel*>(proxyModel->sourceModel());
-
-                    size_t index = static_cast<size_t>(sourceIndex.row());
-                    if ( index < sourceModel->getAssociationReferences().size() ) {
-                        const auto& reference = sourceModel->getAssociationReferences()[index];
-
-                        m_model.removeAssociation( reference.deviceIndex, reference.channelIndex, reference.groupIndex, { reference.targetDeviceIndex, reference.targetChannelIndex } );
-
-                        proxyModel->setSourceModel( new SourceModel( m_model ) );
-                        static_cast<QAbstractProxyModel*>( m_hintAssociationsView->model() )->setSourceModel( new HintSourceModel( m_model ) );
-                    }
-                }
+                editSelectedAssociations( m_existingAssociationsView, false );
             });
         }
 
@@ -422,14 +284,14 @@ You may remove association by selecting it and pressing the button.)");
 
 
             m_hintAssociationsView = new QListView(this);
-            m_hintAssociationsView->setModel( new AssociationListProxyModel( new HintSourceModel( m_model ) ) );
             m_hintAssociationsView->setItemDelegate(new ItemDelegate);
+            m_hintAssociationsView->setSelectionMode(QListView::ExtendedSelection);
 
             m_hintAssociationsView->setToolTip(
 R"(This is a list all the associations that could be added.
 They are matching to the selected filter (source node, source channel, source group, target node, target channel).
-If you want to add the association select it and press the button.
-Note, the list should contain more relevant associations at the top. Less relevant ones should be below and lit with another color.
+If you want to add associations select them and press the button.
+More relevant associations are at the top: Lifeline to the hub first, then targets supporting the group profile. Less relevant ones are below and dimmed.
 Flow of adding a association for a simple user:
     He just selects the association from the list with filtered source node only.
     User doesn't have to know all the details about zwave associations.
@@ -438,7 +300,7 @@ Flow of adding a association for an advanced user:
 
             viewsLayout->addWidget(m_hintAssociationsView, 1, 1);
 
-            auto addAssociationButton = new QPushButton("Add Selected Association", this);
+            auto addAssociationButton = new QPushButton("Add Selected Associations", this);
             viewsLayout->addWidget(addAssociationButton, 2, 1);
 
             addAssociationButton->setToolTip(
@@ -452,37 +314,58 @@ Target is node+channel or just node (whole node))");
 
 
             connect(addAssociationButton, &QPushButton::clicked, this, [=]() {
-                auto selectedIndexes = m_hintAssociationsView->selectionModel()->selectedIndexes();
-                if ( !selectedIndexes.empty() ) {
-                    auto proxyModel = static_cast<QAbstractProxyModel*>( m_hintAssociationsView->model() );
-                    auto sourceIndex = proxyModel->mapToSource(selectedIndexes.front());
-                    auto sourceModel = static_cast<BaseSourceModel*>(proxyModel->sourceModel());
-
-                    size_t index = static_cast<size_t>(sourceIndex.row());
-                    if ( index < sourceModel->getAssociationReferences().size() ) {
-                        const auto& reference = sourceModel->getAssociationReferences()[index];
-
-                        m_model.addAssociation( reference.deviceIndex, reference.channelIndex, reference.groupIndex, { reference.targetDeviceIndex, reference.targetChannelIndex } );
-
-                        proxyModel->setSourceModel( new HintSourceModel( m_model ) );
-                        static_cast<QAbstractProxyModel*>( m_existingAssociationsView->model() )->setSourceModel( new SourceModel( m_model ) );
-                    }
-                }
+                editSelectedAssociations( m_hintAssociationsView, true );
             });
         }
     }
 
-    updateSourceNodeCombo(index + 1);
+    m_modelsBuilder = new AssociationModelsBuilder(this);
+
+    connect( m_modelsBuilder, &AssociationModelsBuilder::finished, this, [this]() {
+        auto result = m_modelsBuilder->takeResult();
+
+        setAssociationModels( new SourceModel( m_model, std::move( result.associationReferences ) ),
+                              new HintSourceModel( m_model, std::move( result.candidates ) ) );
+    } );
+
+    resetAssociationModels();
+
+    m_groupNamesIndex.build( m_model );
+
+    updateSourceNodeCombo();
 
     updateTargetNodeCombo();
 
     connect( m_targetNodeCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &AssociationsWizard::updateTargetChannelCombo );
     connect( m_sourceChannelCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &AssociationsWizard::updateSourceGroupsCombo );
-    connect( m_sourceNodeCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &AssociationsWizard::updateSourceChannelsCombo );
+    connect( m_sourceNodeCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, [this](int index) {
+        m_sourceDevice = index > 0 ? std::optional<DevicesModel::DeviceHandle>( m_model.getDeviceHandle( index - 1 ) ) : std::optional<DevicesModel::DeviceHandle>();
+        updateSourceChannelsCombo();
+    } );
+
+    m_changesListenerId = m_model.addChangesListener( [this](const std::vector<DevicesModel::Change>& changes) {
+        applyModelChanges( changes );
+    } );
+}
+
+AssociationsWizard::~AssociationsWizard() {
+    m_model.removeChangesListener( m_changesListenerId );
+}
+
+void AssociationsWizard::setSourceDevice(DevicesModel::DeviceHandle sourceDevice, std::optional<size_t>) {
+    catchUpWithDevices();
+
+    const auto index = m_model.findDeviceIndex( sourceDevice );
+    m_sourceNodeCombo->setCurrentIndex( index ? static_cast<int>( *index + 1 ) : 0 );
+}
+
+void AssociationsWizard::showEvent(QShowEvent* event) {
+    catchUpWithDevices();
 
+    QWidget::showEvent( event );
 }
 
-void AssociationsWizard::updateSourceNodeCombo(std::optional<size_t> currentIndex) {
+void AssociationsWizard::updateSourceNodeCombo() {
     QStringList stringList;
 
     stringList.append("Not specified");
@@ -491,10 +374,17 @@ void AssociationsWizard::updateSourceNodeCombo(std::optional<size_t> currentInde
         stringList.append( QString("Node ") + QString::number(device.nodeId) + " (" + QString::fromStdString( device.name ) + ")" );
     }
 
-    static_cast< QStringListModel* >( m_sourceNodeCombo->model() )->setStringList(stringList);
+    // a removal moves the last device into the freed row, so the selected node is found by its handle
+    const auto deviceIndex = m_sourceDevice ? m_model.findDeviceIndex( *m_sourceDevice ) : std::optional<size_t>();
+    if ( !deviceIndex )
+        m_sourceDevice.reset();
 
-    if (currentIndex)
-        m_sourceNodeCombo->setCurrentIndex(*currentIndex);
+    {
+        QSignalBlocker blocker( m_sourceNodeCombo );
+
+        static_cast< QStringListModel* >( m_sourceNodeCombo->model() )->setStringList(stringList);
+        m_sourceNodeCombo->setCurrentIndex( deviceIndex ? static_cast<int>( *deviceIndex + 1 ) : 0 );
+    }
 
     updateSourceChannelsCombo();
 }
@@ -531,37 +421,11 @@ void AssociationsWizard::updateSourceGroupsCombo() {
 
     stringList.append("Not specified");
 
-    auto handleGroups = [&](const std::vector<DevicesModel::AssociationGroup>& groups) {
-          for ( auto& group : groups ) {
-              stringList.append( QString::fromStdString( group.name ) );
-          }
-    };
-
-    auto handleDevice = [&](const DevicesModel::Device& device) {
-        if ( m_sourceChannelCombo->currentIndex() <= 0 ) {
-            const size_t index = m_sourceChannelCombo->currentIndex() - 1;
-            if ( index < device.channelsToGroups.size() ) {
-                handleGroups( device.channelsToGroups[index] );
-            }
-        }
-        else {
-            for ( auto& groups : device.channelsToGroups ) {
-                handleGroups( groups );
-            }
-        }
-    };
-
-    if ( m_sourceNodeCombo->currentIndex() <= 0 ) {
-        for ( auto& device : m_model.getDevices() ) {
-             handleDevice( device );
-        }
-    }
-    else {
-        handleDevice( m_model.getDevices()[ m_sourceNodeCombo->currentIndex() - 1 ] );
-    }
+    const int nodeIndex = m_sourceNodeCombo->currentIndex();
+    const int channelIndex = m_sourceChannelCombo->currentIndex();
 
-    std::sort( stringList.begin() + 1, stringList.end() );
-    stringList.erase( std::unique(stringList.begin() + 1, stringList.end()), stringList.end() );
+    stringList.append( m_groupNamesIndex.getNames( nodeIndex > 0 ? std::optional<size_t>( nodeIndex - 1 ) : std::optional<size_t>(),
+                                                   channelIndex > 0 ? std::optional<size_t>( channelIndex - 1 ) : std::optional<size_t>() ) );
 
     updateComboModelWithSavingText(m_sourceGroupCombo, stringList);
 
@@ -612,6 +476,169 @@ void AssociationsWizard::updateTargetChannelCombo() {
     invalidateFilters();
 }
 
+void AssociationsWizard::editSelectedAssociations(QListView* view, bool add) {
+    auto proxyModel = view == m_hintAssociationsView ? m_hintProxyModel : m_existingProxyModel;
+    auto sourceModel = static_cast<BaseSourceModel*>( proxyModel->sourceModel() );
+
+    std::vector<AssociationInfo> references;
+
+    for ( const auto& selectedIndex : view->selectionModel()->selectedIndexes() ) {
+        auto sourceIndex = selectedIndex;
+        while ( sourceIndex.model() != sourceModel ) {
+            sourceIndex = static_cast<const QAbstractProxyModel*>( sourceIndex.model() )->mapToSource( sourceIndex );
+        }
+
+        const size_t index = static_cast<size_t>( sourceIndex.row() );
+
+        if ( index < sourceModel->getAssociationsCount() ) {
+            references.push_back( sourceModel->getAssociation( index ) );
+        }
+    }
+
+    if ( references.empty() )
+        return;
+
+    m_model.beginAssociationsBatch();
+
+    for ( const auto& reference : references ) {
+        const DevicesModel::Association association = { reference.targetDeviceIndex, reference.targetChannelIndex };
+
+        if ( add )
+            m_model.addAssociation( reference.deviceIndex, reference.channelIndex, reference.groupIndex, association );
+        else
+            m_model.removeAssociation( reference.deviceIndex, reference.channelIndex, reference.groupIndex, association );
+    }
+
+    DevicesModel::AssociationRejection rejection;
+
+    if ( !m_model.commitAssociationsBatch( rejection ) ) {
+        QString reason;
+
+        switch ( rejection ) {
+        case DevicesModel::GroupFull:
+            reason = "a group would exceed its capacity";
+            break;
+        case DevicesModel::MissingAssociation:
+            reason = "an association is not there anymore";
+            break;
+        case DevicesModel::UnknownTarget:
+            reason = "a target node or channel does not exist";
+            break;
+        case DevicesModel::UnknownGroup:
+        case DevicesModel::NoRejection:
+            reason = "a source group does not exist";
+            break;
+        }
+
+        QMessageBox::warning( this, "Associations Editor",
+                              QString( "The selected associations cannot all be %1: %2. No association was changed." ).arg( add ? "added" : "removed", reason ) );
+    }
+}
+
+void AssociationsWizard::updateAssociationGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex) {
+    for ( auto proxyModel : { m_existingProxyModel, m_hintProxyModel } ) {
+        static_cast<BaseSourceModel*>( proxyModel->sourceModel() )->updateGroup( deviceIndex, channelIndex, groupIndex );
+    }
+}
+
+void AssociationsWizard::applyModelChanges(const std::vector<DevicesModel::Change>& changes) {
+    std::set< std::tuple<size_t, size_t, size_t> > groups;
+    bool devicesChanged = false;
+
+    for ( const auto& change : changes ) {
+        switch ( change.type ) {
+        case DevicesModel::Change::DeviceAdded:
+        case DevicesModel::Change::DeviceRemoved:
+            devicesChanged = true;
+            break;
+        case DevicesModel::Change::GroupCapacityChanged:
+        case DevicesModel::Change::AssociationAdded:
+        case DevicesModel::Change::AssociationRemoved:
+            groups.emplace( change.deviceIndex, change.channelIndex, change.groupIndex );
+            break;
+        }
+    }
+
+    // the lists are empty until the wizard is shown again, nothing to update in them
+    if ( m_devicesOutdated )
+        return;
+
+    // rows still being built miss these changes, so the build starts over from the current network
+    if ( !devicesChanged && m_modelsBuilder->isRunning() ) {
+        m_modelsBuilder->start( m_model.getFlatAssociationsSnapshot() );
+        return;
+    }
+
+    // device indices are shifted by a removal, so the rows of both lists are rebuilt
+    if ( devicesChanged ) {
+        if ( isVisible() ) {
+            updateDevices();
+        }
+        else {
+            // rows referring to shifted devices are dropped right away, everything else waits
+            m_devicesOutdated = true;
+            m_modelsBuilder->cancel();
+            setAssociationModels( new SourceModel( m_model, std::vector<PackedAssociationInfo>() ), new HintSourceModel( m_model, HintSourceModel::Candidates() ) );
+        }
+
+        return;
+    }
+
+    for ( const auto& [deviceIndex, channelIndex, groupIndex] : groups ) {
+        updateAssociationGroup( deviceIndex, channelIndex, groupIndex );
+    }
+}
+
+void AssociationsWizard::updateDevices() {
+    resetAssociationModels();
+
+    m_groupNamesIndex.build( m_model );
+
+    updateSourceNodeCombo();
+    updateTargetNodeCombo();
+
+    updateExtraValuesLabels();
+}
+
+void AssociationsWizard::catchUpWithDevices() {
+    if ( !m_devicesOutdated )
+        return;
+
+    m_devicesOutdated = false;
+    updateDevices();
+}
+
+void AssociationsWizard::resetAssociationModels() {
+    // the current rows may refer to shifted devices, so the lists stay empty until the new rows arrive
+    setAssociationModels( new SourceModel( m_model, std::vector<PackedAssociationInfo>() ), new HintSourceModel( m_model, HintSourceModel::Candidates() ) );
+
+    m_modelsBuilder->start( m_model.getFlatAssociationsSnapshot() );
+}
+
+void AssociationsWizard::setAssociationModels(BaseSourceModel* existingModel, BaseSourceModel* hintModel) {
+    auto setViewModel = [](QListView* view, QAbstractItemModel* model) {
+        auto oldModel = view->model();
+
+        model->setParent( view );
+        view->setModel( model );
+
+        delete oldModel;
+    };
+
+    m_existingProxyModel = new AssociationListProxyModel( existingModel );
+    existingModel->setParent( m_existingProxyModel );
+    setViewModel( m_existingAssociationsView, m_existingProxyModel );
+
+    m_hintProxyModel = new AssociationListProxyModel( hintModel );
+    hintModel->setParent( m_hintProxyModel );
+
+    auto rankedModel = new RankedAssociationsProxyModel( m_hintProxyModel );
+    m_hintProxyModel->setParent( rankedModel );
+    setViewModel( m_hintAssociationsView, rankedModel );
+
+    invalidateFilters();
+}
+
 void AssociationsWizard::invalidateFilters() {
     if (!m_filtersInvalidated) {
         m_filtersInvalidated = true;
@@ -625,31 +652,70 @@ void AssociationsWizard::updateFilters() {
 
     FilterInfo filterInfo;
 
+    auto insertDevices = [this](const std::vector<DevicesModel::DeviceHandle>& handles, IndexSet& indices) {
+        for ( const auto& handle : handles ) {
+            if ( const auto deviceIndex = m_model.findDeviceIndex( handle ) )
+                indices.insert( *deviceIndex );
+        }
+    };
+
     if ( m_sourceNodeCombo->currentIndex() > 0 ) {
-        filterInfo.deviceIndex = m_sourceNodeCombo->currentIndex() - 1;
+        filterInfo.deviceIndices.insert( m_sourceNodeCombo->currentIndex() - 1 );
     }
 
+    insertDevices( m_extraSourceDevices, filterInfo.deviceIndices );
+
     if ( m_sourceChannelCombo->currentIndex() > 0 ) {
-        filterInfo.channelIndex = m_sourceChannelCombo->currentIndex() - 1;
+        filterInfo.channelIndices.insert( m_sourceChannelCombo->currentIndex() - 1 );
     }
 
     if ( m_sourceGroupCombo->currentIndex() > 0 ) {
-        filterInfo.groupName = m_sourceGroupCombo->currentText().toStdString();
+        filterInfo.groupNames.push_back( m_sourceGroupCombo->currentText().toStdString() );
+    }
+
+    for ( const auto& groupName : m_extraSourceGroups ) {
+        filterInfo.groupNames.push_back( groupName.toStdString() );
     }
 
     if ( m_targetNodeCombo->currentIndex() > 0 ) {
-        filterInfo.targetDeviceIndex = m_targetNodeCombo->currentIndex() - 1;
+        filterInfo.targetDeviceIndices.insert( m_targetNodeCombo->currentIndex() - 1 );
     }
 
+    insertDevices( m_extraTargetDevices, filterInfo.targetDeviceIndices );
+
     if ( m_targetChannelCombo->currentIndex() > 0 ) {
-        filterInfo.targetChannelIndex = m_targetChannelCombo->currentIndex() == 1 ?
-                    std::optional<size_t>() :
-                    std::optional<size_t>( m_targetChannelCombo->currentIndex() - 2 );
+        filterInfo.targetChannels.insert( FilterInfo::encodeTargetChannel( m_targetChannelCombo->currentIndex() == 1 ?
+                                                                             std::optional<size_t>() :
+                                                                             std::optional<size_t>( m_targetChannelCombo->currentIndex() - 2 ) ) );
     }
 
-    static_cast< AssociationListProxyModel* >( m_existingAssociationsView->model() )->setFilter( filterInfo );
+    m_existingProxyModel->setFilter( filterInfo );
     m_existingAssociationsView->update();
 
-    static_cast< AssociationListProxyModel* >( m_hintAssociationsView->model() )->setFilter( filterInfo );
+    m_hintProxyModel->setFilter( filterInfo );
     m_hintAssociationsView->update();
 }
+
+void AssociationsWizard::updateExtraValuesLabels() {
+    auto updateDevicesLabel = [this](std::vector<DevicesModel::DeviceHandle>& handles, QLabel* label) {
+        QStringList names;
+
+        auto end = std::remove_if( handles.begin(), handles.end(), [this](const DevicesModel::DeviceHandle& handle) {
+            return !m_model.findDeviceIndex( handle );
+        } );
+        handles.erase( end, handles.end() );
+
+        for ( const auto& handle : handles ) {
+            const auto& device = m_model.getDevices()[*m_model.findDeviceIndex( handle )];
+            names.append( QString("Node ") + QString::number(device.nodeId) + " (" + QString::fromStdString( device.name ) + ")" );
+        }
+
+        setExtraValues( label, names );
+    };
+
+    updateDevicesLabel( m_extraSourceDevices, m_extraSourceDevicesLabel );
+    updateDevicesLabel( m_extraTargetDevices, m_extraTargetDevicesLabel );
+    setExtraValues( m_extraSourceGroupsLabel, m_extraSourceGroups );
+
+    invalidateFilters();
+}
@@ -2,11 +2,16 @@
 #include <QWidget>
 
 #include "devices_model.h"
+#include "group_names_index.h"
 #include <optional>
 #include <memory>
 
 class QComboBox;
+class QLabel;
 class QListView;
+class AssociationListProxyModel;
+class AssociationModelsBuilder;
+class BaseSourceModel;
 
 class AssociationsWizard : public QWidget
 {
@@ -14,17 +19,25 @@ class AssociationsWizard : public QWidget
 
     Q_OBJECT
 public:
-    explicit AssociationsWizard(DevicesModel& model, size_t index, std::optional<size_t> subIndex, QWidget *parent = nullptr);
+    explicit AssociationsWizard(DevicesModel& model, DevicesModel::DeviceHandle sourceDevice, std::optional<size_t> subIndex, QWidget *parent = nullptr);
 
+    ~AssociationsWizard() override;
+
+    // Selects the source node, keeping the other filters and the selection when it is already selected.
+    void setSourceDevice(DevicesModel::DeviceHandle sourceDevice, std::optional<size_t> subIndex);
+
+protected:
+    void showEvent(QShowEvent* event) override;
 
 signals:
     void backClicked();
 
-    void groupsWizardRequested(size_t, size_t, size_t);
+    void groupsWizardRequested(DevicesModel::DeviceHandle, size_t, size_t);
 
 private:
 
-    void updateSourceNodeCombo(std::optional<size_t> currentIndex);
+    // Keeps the node of m_sourceDevice selected, or none if it was removed.
+    void updateSourceNodeCombo();
 
     void updateSourceChannelsCombo();
 
@@ -35,15 +48,38 @@ private:
 
     void updateTargetChannelCombo();
 
+    void editSelectedAssociations(QListView* view, bool add);
+
+    void updateAssociationGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex);
+
+    void applyModelChanges(const std::vector<DevicesModel::Change>& changes);
+
+    // Rebuilds everything that depends on device positions.
+    void updateDevices();
+
+    // A hidden wizard postpones updateDevices() until it is needed.
+    void catchUpWithDevices();
+
+    // Empties both lists and rebuilds their rows on a worker thread.
+    void resetAssociationModels();
+
+    void setAssociationModels(BaseSourceModel* existingModel, BaseSourceModel* hintModel);
+
     void invalidateFilters();
 
     void updateFilters();
 
+    // Drops the extra nodes that were removed and shows what is left next to the combos.
+    void updateExtraValuesLabels();
+
     //std::shared_ptr<FiltersUpdater> createFiltersUpdater
 
 private:
     DevicesModel& m_model;
 
+    // the node selected in the source combo, by handle since its row moves when devices are removed
+    std::optional<DevicesModel::DeviceHandle> m_sourceDevice;
+
     QComboBox* m_sourceNodeCombo = nullptr;
     QComboBox* m_sourceChannelCombo = nullptr;
     QComboBox* m_sourceGroupCombo = nullptr;
@@ -51,10 +87,30 @@ private:
     QComboBox* m_targetNodeCombo = nullptr;
     QComboBox* m_targetChannelCombo = nullptr;
 
+    // values the filters accept besides the ones selected in the combos
+    std::vector<DevicesModel::DeviceHandle> m_extraSourceDevices;
+    QStringList m_extraSourceGroups;
+    std::vector<DevicesModel::DeviceHandle> m_extraTargetDevices;
+
+    QLabel* m_extraSourceDevicesLabel = nullptr;
+    QLabel* m_extraSourceGroupsLabel = nullptr;
+    QLabel* m_extraTargetDevicesLabel = nullptr;
+
     QListView* m_existingAssociationsView = nullptr;
     QListView* m_hintAssociationsView = nullptr;
 
+    // the hint view shows its list through a ranking proxy on top of it
+    AssociationListProxyModel* m_existingProxyModel = nullptr;
+    AssociationListProxyModel* m_hintProxyModel = nullptr;
+
+    AssociationModelsBuilder* m_modelsBuilder = nullptr;
+
+    GroupNamesIndex m_groupNamesIndex;
+
     bool m_filtersInvalidated = false;
+    bool m_devicesOutdated = false;
+
+    size_t m_changesListenerId = 0;
 };
 
 
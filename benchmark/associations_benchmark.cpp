@@ -0,0 +1,671 @@
+#include "association_models.h"
+#include "devices_snapshot.h"
+#include "flat_associations.h"
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct NetworkParameters {
+    size_t nodes = 100;
+    size_t channelsPerNode = 2;
+    size_t groupsPerChannel = 3;
+    size_t maxAssociationsNumber = 10;
+    double fillRatio = 0.5;
+};
+
+template<typename Function>
+double measureMs(Function function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+void printResult(const NetworkParameters& parameters, const std::string& benchmark, size_t rows, double ms) {
+    std::printf( "{\"benchmark\": \"%s\", \"nodes\": %zu, \"channels\": %zu, \"groups\": %zu, \"max_associations\": %zu, "
+                 "\"fill\": %.2f, \"rows\": %zu, \"ms\": %.3f}\n",
+                 benchmark.c_str(), parameters.nodes, parameters.channelsPerNode, parameters.groupsPerChannel,
+                 parameters.maxAssociationsNumber, parameters.fillRatio, rows, ms );
+}
+
+// Hardware cache misses of the calling thread; -1 where perf events are not available (non-Linux, containers, perf_event_paranoid).
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attributes = {};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        m_fd = static_cast<int>( syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if ( m_fd >= 0 )
+            close( m_fd );
+#endif
+    }
+
+    template<typename Function>
+    long long count(Function function) {
+#ifdef __linux__
+        if ( m_fd >= 0 ) {
+            ioctl( m_fd, PERF_EVENT_IOC_RESET, 0 );
+            ioctl( m_fd, PERF_EVENT_IOC_ENABLE, 0 );
+            function();
+            ioctl( m_fd, PERF_EVENT_IOC_DISABLE, 0 );
+
+            long long misses = 0;
+            if ( read( m_fd, &misses, sizeof(misses) ) == sizeof(misses) )
+                return misses;
+
+            return -1;
+        }
+#endif
+        function();
+        return -1;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+// Resident set size of the process; -1 where /proc is not available.
+long long residentBytes() {
+#ifdef __linux__
+    long long pages = 0;
+    long long residentPages = 0;
+
+    if ( FILE* file = std::fopen( "/proc/self/statm", "r" ) ) {
+        const bool parsed = std::fscanf( file, "%lld %lld", &pages, &residentPages ) == 2;
+        std::fclose( file );
+
+        if ( parsed )
+            return residentPages * sysconf( _SC_PAGESIZE );
+    }
+#endif
+    return -1;
+}
+
+void printMemoryResult(const NetworkParameters& parameters, const std::string& benchmark, size_t rows, long long bytes) {
+    std::printf( "{\"benchmark\": \"%s\", \"nodes\": %zu, \"channels\": %zu, \"groups\": %zu, \"max_associations\": %zu, "
+                 "\"fill\": %.2f, \"rows\": %zu, \"bytes\": %lld}\n",
+                 benchmark.c_str(), parameters.nodes, parameters.channelsPerNode, parameters.groupsPerChannel,
+                 parameters.maxAssociationsNumber, parameters.fillRatio, rows, bytes );
+}
+
+// The baseline predicate: every optional field of the filter checked in turn, group names compared as strings.
+bool matchesGeneric(const DevicesModel& model, const FilterInfo& filterInfo, const AssociationInfo& info) {
+    if ( !filterInfo.deviceIndices.isEmpty() && !filterInfo.deviceIndices.contains( info.deviceIndex ) )
+        return false;
+
+    if ( !filterInfo.channelIndices.isEmpty() && !filterInfo.channelIndices.contains( info.channelIndex ) )
+        return false;
+
+    if ( !filterInfo.groupNames.empty() ) {
+        const auto& group = model.getDevices()[info.deviceIndex].channelsToGroups[info.channelIndex][info.groupIndex];
+
+        if ( std::find( filterInfo.groupNames.begin(), filterInfo.groupNames.end(), group.name ) == filterInfo.groupNames.end() )
+            return false;
+    }
+
+    if ( !filterInfo.targetDeviceIndices.isEmpty() && !filterInfo.targetDeviceIndices.contains( info.targetDeviceIndex ) )
+        return false;
+
+    if ( !filterInfo.targetChannels.isEmpty() && !filterInfo.targetChannels.contains( FilterInfo::encodeTargetChannel( info.targetChannelIndex ) ) )
+        return false;
+
+    return true;
+}
+
+void printCacheResult(const NetworkParameters& parameters, const std::string& benchmark, size_t rows, double ms, size_t hits, size_t misses) {
+    std::printf( "{\"benchmark\": \"%s\", \"nodes\": %zu, \"channels\": %zu, \"groups\": %zu, \"max_associations\": %zu, "
+                 "\"fill\": %.2f, \"rows\": %zu, \"ms\": %.3f, \"cache_hits\": %zu, \"cache_misses\": %zu}\n",
+                 benchmark.c_str(), parameters.nodes, parameters.channelsPerNode, parameters.groupsPerChannel,
+                 parameters.maxAssociationsNumber, parameters.fillRatio, rows, ms, hits, misses );
+}
+
+void fillNetwork(DevicesModel& model, const NetworkParameters& parameters, std::mt19937& random) {
+    for ( size_t node = 0; node < parameters.nodes; ++node ) {
+        DevicesModel::Device device;
+        device.name = "Node " + std::to_string( node );
+
+        for ( size_t channel = 0; channel < parameters.channelsPerNode; ++channel ) {
+            std::vector<DevicesModel::AssociationGroup> groups;
+
+            for ( size_t groupIndex = 0; groupIndex < parameters.groupsPerChannel; ++groupIndex ) {
+                DevicesModel::AssociationGroup group;
+                group.name = groupIndex == 0 ? "Lifeline" : "Group " + std::to_string( groupIndex );
+                group.profile = "General:NA";
+                group.maxAssociationsNumber = static_cast<uint8_t>( parameters.maxAssociationsNumber );
+
+                groups.push_back( std::move( group ) );
+            }
+
+            device.channelsToGroups.push_back( std::move( groups ) );
+        }
+
+        model.addDevice( std::move( device ) );
+    }
+
+    const auto& devices = model.getDevices();
+    const size_t fillNumber = static_cast<size_t>( parameters.fillRatio * parameters.maxAssociationsNumber + 0.5 );
+
+    for ( size_t deviceIndex = 0; deviceIndex < devices.size(); ++deviceIndex ) {
+        for ( size_t channelIndex = 0; channelIndex < devices[deviceIndex].channelsToGroups.size(); ++channelIndex ) {
+            for ( size_t groupIndex = 0; groupIndex < devices[deviceIndex].channelsToGroups[channelIndex].size(); ++groupIndex ) {
+                for ( size_t attempt = 0; attempt < fillNumber * 2; ++attempt ) {
+                    const auto& group = devices[deviceIndex].channelsToGroups[channelIndex][groupIndex];
+                    if ( group.associations.size() >= fillNumber )
+                        break;
+
+                    DevicesModel::Association association;
+                    association.deviceIndex = random() % devices.size();
+
+                    const size_t channelsCount = devices[association.deviceIndex].channelsToGroups.size();
+                    if ( channelsCount > 0 && random() % 2 )
+                        association.channelIndex = random() % channelsCount;
+
+                    if ( association.deviceIndex == deviceIndex ||
+                         std::find( group.associations.begin(), group.associations.end(), association ) != group.associations.end() )
+                        continue;
+
+                    model.addAssociation( deviceIndex, channelIndex, groupIndex, association );
+                }
+            }
+        }
+    }
+}
+
+// The fields in mask take the values of all the samples.
+FilterInfo createFilter(const DevicesModel& model, const std::vector<AssociationInfo>& samples, unsigned mask) {
+    FilterInfo filterInfo;
+
+    for ( const auto& sample : samples ) {
+        if ( mask & 1 )
+            filterInfo.deviceIndices.insert( sample.deviceIndex );
+
+        if ( mask & 2 )
+            filterInfo.channelIndices.insert( sample.channelIndex );
+
+        if ( mask & 4 )
+            filterInfo.groupNames.push_back( model.getDevices()[sample.deviceIndex].channelsToGroups[sample.channelIndex][sample.groupIndex].name );
+
+        if ( mask & 8 )
+            filterInfo.targetDeviceIndices.insert( sample.targetDeviceIndex );
+
+        if ( mask & 16 )
+            filterInfo.targetChannels.insert( FilterInfo::encodeTargetChannel( sample.targetChannelIndex ) );
+    }
+
+    return filterInfo;
+}
+
+std::string maskToString(unsigned mask) {
+    static const char* names[] = { "node", "channel", "group", "target_node", "target_channel" };
+
+    std::string result;
+    for ( unsigned bit = 0; bit < 5; ++bit ) {
+        if ( mask & ( 1u << bit ) ) {
+            result += result.empty() ? "" : "+";
+            result += names[bit];
+        }
+    }
+
+    return result.empty() ? "none" : result;
+}
+
+void benchmarkFilters(const NetworkParameters& parameters, const std::string& name, BaseSourceModel* sourceModel) {
+    AssociationListProxyModel proxyModel( sourceModel );
+
+    if ( sourceModel->getAssociationsCount() == 0 )
+        return;
+
+    const auto sample = sourceModel->getAssociation( sourceModel->getAssociationsCount() / 2 );
+
+    // the first pass over the rows runs the batch filter, the second one indexes stored rows and scans again otherwise
+    printResult( parameters, name + "_filter_batch_scan", sourceModel->getAssociationsCount(), measureMs( [&]() {
+        proxyModel.setFilter( createFilter( sourceModel->getDevicesModel(), { sample }, 1 ) );
+    } ) );
+
+    printResult( parameters, name + ( sourceModel->storesRows() ? "_filter_index_build" : "_filter_batch_rescan" ), sourceModel->getAssociationsCount(), measureMs( [&]() {
+        proxyModel.setFilter( createFilter( sourceModel->getDevicesModel(), { sample }, 2 ) );
+    } ) );
+
+    for ( unsigned mask = 0; mask < 32; ++mask ) {
+        const auto filterInfo = createFilter( sourceModel->getDevicesModel(), { sample }, mask );
+
+        const auto ms = measureMs( [&]() {
+            proxyModel.setFilter( filterInfo );
+        } );
+
+        printResult( parameters, name + "_filter_" + maskToString( mask ), proxyModel.rowCount(), ms );
+    }
+
+    // one filter with a set of source nodes against one filter per node
+    const size_t devicesCount = sourceModel->getDevicesModel().getDevices().size();
+
+    for ( size_t nodesCount : { size_t( 4 ), size_t( 32 ) } ) {
+        std::vector<AssociationInfo> samples;
+        for ( size_t index = 0; index < nodesCount; ++index ) {
+            samples.push_back( sample );
+            samples.back().deviceIndex = ( sample.deviceIndex + index * 7 ) % devicesCount;
+        }
+
+        const auto filterInfo = createFilter( sourceModel->getDevicesModel(), samples, 1 );
+
+        const auto setMs = measureMs( [&]() {
+            proxyModel.setFilter( filterInfo );
+        } );
+
+        printResult( parameters, name + "_filter_nodes_set_" + std::to_string( nodesCount ), proxyModel.rowCount(), setMs );
+
+        size_t rowsCount = 0;
+        const auto eachMs = measureMs( [&]() {
+            for ( const auto& nodeSample : samples ) {
+                proxyModel.setFilter( createFilter( sourceModel->getDevicesModel(), { nodeSample }, 1 ) );
+                rowsCount += proxyModel.rowCount();
+            }
+        } );
+
+        printResult( parameters, name + "_filter_nodes_each_" + std::to_string( nodesCount ), rowsCount, eachMs );
+    }
+}
+
+// Per-row cost of the filter predicate alone, over rows unpacked beforehand: the generic check of every optional
+// field against the predicate compiled for the active fields, and the batch filter over the packed rows.
+// "rows" is the number of rows checked.
+void benchmarkFilterPredicates(const NetworkParameters& parameters, const std::string& name, BaseSourceModel* sourceModel) {
+    const auto& devicesModel = sourceModel->getDevicesModel();
+
+    std::vector<AssociationInfo> rows;
+    rows.reserve( sourceModel->getAssociationsCount() );
+
+    for ( size_t row = 0; row < sourceModel->getAssociationsCount(); ++row ) {
+        rows.push_back( sourceModel->getAssociation( row ) );
+    }
+
+    if ( rows.empty() )
+        return;
+
+    std::vector<PackedAssociationInfo> packedRows( rows.size() );
+
+    printResult( parameters, name + "_batch_copy_rows", rows.size(), measureMs( [&]() {
+        sourceModel->copyRows( 0, packedRows.size(), packedRows.data() );
+    } ) );
+
+    for ( size_t row = 0; row < rows.size(); ++row ) {
+        if ( !( packedRows[row].unpack() == rows[row] ) ) {
+            std::fprintf( stderr, "%s row %zu: copyRows() differs from getAssociation()\n", name.c_str(), row );
+            std::exit( 1 );
+        }
+    }
+
+    // a single value per field, then two: the batch filter leaves fields with several values to its scalar pass
+    const std::vector<AssociationInfo> samples = { rows[rows.size() / 2], rows[rows.size() / 3] };
+
+    for ( unsigned combination = 0; combination < 2 * AssociationFilter::FieldsCombinationsNumber; ++combination ) {
+        const unsigned mask = combination % AssociationFilter::FieldsCombinationsNumber;
+        const size_t samplesCount = combination < AssociationFilter::FieldsCombinationsNumber ? 1 : 2;
+        const auto filterInfo = createFilter( devicesModel, std::vector<AssociationInfo>( samples.begin(), samples.begin() + samplesCount ), mask );
+        const std::string suffix = maskToString( mask ) + ( samplesCount > 1 ? "_two_values" : "" );
+
+        size_t genericMatches = 0;
+        const auto genericMs = measureMs( [&]() {
+            for ( const auto& info : rows ) {
+                genericMatches += matchesGeneric( devicesModel, filterInfo, info );
+            }
+        } );
+
+        const AssociationFilter filter( devicesModel, filterInfo );
+
+        size_t compiledMatches = 0;
+        const auto compiledMs = measureMs( [&]() {
+            filter.visit( [&](auto matches) {
+                for ( const auto& info : rows ) {
+                    compiledMatches += matches( info );
+                }
+            } );
+        } );
+
+        const AssociationBatchFilter batchFilter( devicesModel, filterInfo );
+        RowBitmap bitmap( ( packedRows.size() + 63 ) / 64 );
+
+        const auto batchMs = measureMs( [&]() {
+            batchFilter.match( packedRows.data(), packedRows.size(), bitmap.data() );
+        } );
+
+        size_t batchMatches = 0;
+        for ( size_t row = 0; row < packedRows.size(); ++row ) {
+            batchMatches += testRow( bitmap, row );
+        }
+
+        // also keeps the loops from being optimized away
+        if ( genericMatches != compiledMatches || genericMatches != batchMatches ) {
+            std::fprintf( stderr, "%s filter %s: %zu generic matches, %zu compiled, %zu batch\n", name.c_str(), suffix.c_str(),
+                          genericMatches, compiledMatches, batchMatches );
+            std::exit( 1 );
+        }
+
+        printResult( parameters, name + "_predicate_generic_" + suffix, rows.size(), genericMs );
+        printResult( parameters, name + "_predicate_compiled_" + suffix, rows.size(), compiledMs );
+        printResult( parameters, name + "_batch_" + AssociationBatchFilter::getKernelName() + "_" + suffix, rows.size(), batchMs );
+    }
+}
+
+// data() calls of a view scrolled down over the first rows a few rows per step, repainting every visible row,
+// and then scrolled back up. "rows" is the number of data() calls; the text cache counters show that only the
+// first paint of a row renders its text.
+void benchmarkScrolling(const NetworkParameters& parameters, const std::string& name, BaseSourceModel* sourceModel) {
+    const size_t visibleRows = 40;
+    const size_t rowsPerStep = 3;
+    const size_t rowsCount = std::min<size_t>( sourceModel->getAssociationsCount(), 50000 );
+
+    if ( rowsCount < visibleRows )
+        return;
+
+    size_t checksum = 0;
+
+    auto paint = [&](size_t firstRow) {
+        for ( size_t row = firstRow; row < firstRow + visibleRows; ++row ) {
+            checksum += sourceModel->data( sourceModel->index( static_cast<int>( row ), 0 ) ).toString().size();
+        }
+    };
+
+    const size_t stepsCount = ( rowsCount - visibleRows ) / rowsPerStep + 1;
+
+    for ( bool down : { true, false } ) {
+        const size_t hits = sourceModel->getTextCache().getHits();
+        const size_t misses = sourceModel->getTextCache().getMisses();
+
+        const auto ms = measureMs( [&]() {
+            for ( size_t step = 0; step < stepsCount; ++step ) {
+                paint( ( down ? step : stepsCount - 1 - step ) * rowsPerStep );
+            }
+        } );
+
+        printCacheResult( parameters, name + ( down ? "_scroll_down_data" : "_scroll_up_data" ), stepsCount * visibleRows, ms,
+                          sourceModel->getTextCache().getHits() - hits, sourceModel->getTextCache().getMisses() - misses );
+    }
+
+    static volatile size_t sink;
+    sink = checksum;
+}
+
+void benchmarkRanking(const NetworkParameters& parameters, BaseSourceModel* sourceModel) {
+    AssociationListProxyModel listModel( sourceModel );
+    RankedAssociationsProxyModel rankedModel( &listModel );
+
+    // the first chunk scores every row, the next ones only select among the rows not ranked yet
+    printResult( parameters, "hint_ranking_first_chunk", sourceModel->getAssociationsCount(), measureMs( [&]() {
+        rankedModel.fetchMore( {} );
+    } ) );
+
+    printResult( parameters, "hint_ranking_next_chunk", sourceModel->getAssociationsCount(), measureMs( [&]() {
+        rankedModel.fetchMore( {} );
+    } ) );
+}
+
+// Counting the candidates inline, on threads for any number of groups, and on threads only past
+// HintSourceModel::MinCandidatesGroupsPerThread, for networks of a few sizes around that threshold.
+// "rows" is the number of groups, "ms" the best of several runs.
+void benchmarkCandidates(const NetworkParameters& parameters) {
+    const size_t groupsPerNode = std::max<size_t>( 1, parameters.channelsPerNode * parameters.groupsPerChannel );
+
+    for ( size_t groupsCount : { size_t( 256 ), size_t( 2048 ), size_t( 16384 ), size_t( 65536 ) } ) {
+        NetworkParameters sizeParameters = parameters;
+        sizeParameters.nodes = std::min( DevicesModel::MaxDevicesNumber, std::max<size_t>( 2, groupsCount / groupsPerNode ) );
+
+        std::mt19937 random( 42 );
+        DevicesModel model;
+        fillNetwork( model, sizeParameters, random );
+
+        const auto& flat = model.getFlatAssociations();
+
+        auto bestMs = [&](size_t minGroupsPerThread) {
+            double result = 0;
+
+            for ( size_t run = 0; run < 5; ++run ) {
+                const auto ms = measureMs( [&]() {
+                    HintSourceModel::createCandidates( flat, minGroupsPerThread );
+                } );
+
+                result = run == 0 ? ms : std::min( result, ms );
+            }
+
+            return result;
+        };
+
+        printResult( sizeParameters, "hint_candidates_inline", flat.getGroupsCount(), bestMs( std::numeric_limits<size_t>::max() ) );
+        printResult( sizeParameters, "hint_candidates_threads", flat.getGroupsCount(), bestMs( 1 ) );
+        printResult( sizeParameters, "hint_candidates_threshold", flat.getGroupsCount(), bestMs( HintSourceModel::MinCandidatesGroupsPerThread ) );
+    }
+}
+
+void benchmarkRoundTrips(const NetworkParameters& parameters, DevicesModel& model, SourceModel& sourceModel, HintSourceModel& hintModel, std::mt19937& random) {
+    const size_t roundTrips = 100;
+    size_t performed = 0;
+
+    const auto ms = measureMs( [&]() {
+        for ( size_t index = 0; index < roundTrips && hintModel.getAssociationsCount() > 0; ++index ) {
+            const auto reference = hintModel.getAssociation( random() % hintModel.getAssociationsCount() );
+            const DevicesModel::Association association = { reference.targetDeviceIndex, reference.targetChannelIndex };
+
+            model.addAssociation( reference.deviceIndex, reference.channelIndex, reference.groupIndex, association );
+            sourceModel.updateGroup( reference.deviceIndex, reference.channelIndex, reference.groupIndex );
+            hintModel.updateGroup( reference.deviceIndex, reference.channelIndex, reference.groupIndex );
+
+            model.removeAssociation( reference.deviceIndex, reference.channelIndex, reference.groupIndex, association );
+            sourceModel.updateGroup( reference.deviceIndex, reference.channelIndex, reference.groupIndex );
+            hintModel.updateGroup( reference.deviceIndex, reference.channelIndex, reference.groupIndex );
+
+            ++performed;
+        }
+    } );
+
+    printResult( parameters, "add_remove_round_trip", performed, performed > 0 ? ms / performed : 0 );
+}
+
+void benchmarkSnapshot(const NetworkParameters& parameters, const DevicesModel& model) {
+    QTemporaryDir directory;
+    const auto fileName = directory.filePath( "network.snapshot" );
+    QString error;
+
+    const auto saveMs = measureMs( [&]() {
+        DevicesSnapshot::save( model, fileName, error );
+    } );
+
+    if ( !error.isEmpty() ) {
+        std::fprintf( stderr, "%s\n", qPrintable( error ) );
+        return;
+    }
+
+    printResult( parameters, "snapshot_save", model.getDevices().size(), saveMs );
+
+    DevicesSnapshot snapshot;
+    std::vector<DevicesModel::Device> devices;
+
+    printResult( parameters, "snapshot_open", model.getDevices().size(), measureMs( [&]() {
+        snapshot.open( fileName, error );
+    } ) );
+
+    printResult( parameters, "snapshot_read_devices", model.getDevices().size(), measureMs( [&]() {
+        devices = snapshot.readDevices();
+    } ) );
+
+    DevicesModel loadedModel;
+    printResult( parameters, "snapshot_set_devices", devices.size(), measureMs( [&]() {
+        loadedModel.setDevices( std::move( devices ) );
+    } ) );
+}
+
+void benchmarkLayouts(const NetworkParameters& parameters, const DevicesModel& model) {
+    CacheMissCounter counter;
+    size_t checksum = 0;
+    size_t associationsCount = 0;
+
+    auto printLayoutResult = [&](const char* benchmark, double ms, long long cacheMisses) {
+        std::printf( "{\"benchmark\": \"%s\", \"nodes\": %zu, \"channels\": %zu, \"groups\": %zu, \"max_associations\": %zu, "
+                     "\"fill\": %.2f, \"rows\": %zu, \"ms\": %.3f, \"cache_misses\": %lld}\n",
+                     benchmark, parameters.nodes, parameters.channelsPerNode, parameters.groupsPerChannel,
+                     parameters.maxAssociationsNumber, parameters.fillRatio, associationsCount, ms, cacheMisses );
+    };
+
+    long long cacheMisses = 0;
+    double ms = measureMs( [&]() {
+        cacheMisses = counter.count( [&]() {
+            model.getFlatAssociations();
+        } );
+    } );
+    printLayoutResult( "flat_layout_build", ms, cacheMisses );
+
+    // both walks visit every association of every group and sum the targets, so neither can be optimized away
+    ms = measureMs( [&]() {
+        cacheMisses = counter.count( [&]() {
+            associationsCount = 0;
+
+            for ( const auto& device : model.getDevices() ) {
+                for ( const auto& groups : device.channelsToGroups ) {
+                    for ( const auto& group : groups ) {
+                        for ( const auto& association : group.associations ) {
+                            checksum += association.deviceIndex + ( association.channelIndex ? *association.channelIndex + 1 : 0 ) + group.maxAssociationsNumber;
+                            ++associationsCount;
+                        }
+                    }
+                }
+            }
+        } );
+    } );
+    printLayoutResult( "nested_layout_walk", ms, cacheMisses );
+
+    const auto& flat = model.getFlatAssociations();
+
+    ms = measureMs( [&]() {
+        cacheMisses = counter.count( [&]() {
+            associationsCount = 0;
+
+            for ( size_t group = 0; group < flat.getGroupsCount(); ++group ) {
+                for ( size_t association = flat.associationOffsets[group]; association < flat.associationOffsets[group + 1]; ++association ) {
+                    checksum += flat.targetDevices[association] + flat.targetChannels[association] + flat.groupMaxAssociations[group];
+                    ++associationsCount;
+                }
+            }
+        } );
+    } );
+    printLayoutResult( "flat_layout_walk", ms, cacheMisses );
+
+    static volatile size_t sink;
+    sink = checksum;
+}
+
+bool parseArguments(int argc, char* argv[], NetworkParameters& parameters) {
+    for ( int index = 1; index + 1 < argc; index += 2 ) {
+        const char* name = argv[index];
+        const char* value = argv[index + 1];
+
+        if ( std::strcmp( name, "--nodes" ) == 0 )
+            parameters.nodes = std::strtoul( value, nullptr, 10 );
+        else if ( std::strcmp( name, "--channels" ) == 0 )
+            parameters.channelsPerNode = std::strtoul( value, nullptr, 10 );
+        else if ( std::strcmp( name, "--groups" ) == 0 )
+            parameters.groupsPerChannel = std::strtoul( value, nullptr, 10 );
+        else if ( std::strcmp( name, "--max-associations" ) == 0 )
+            parameters.maxAssociationsNumber = std::strtoul( value, nullptr, 10 );
+        else if ( std::strcmp( name, "--fill" ) == 0 )
+            parameters.fillRatio = std::strtod( value, nullptr );
+        else
+            return false;
+    }
+
+    return argc % 2 == 1 && parameters.maxAssociationsNumber <= 255 && parameters.nodes <= DevicesModel::MaxDevicesNumber &&
+           parameters.channelsPerNode <= DevicesModel::MaxChannelsNumber && parameters.groupsPerChannel <= DevicesModel::MaxGroupsNumber;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    NetworkParameters parameters;
+
+    if ( !parseArguments( argc, argv, parameters ) ) {
+        std::fprintf( stderr, "Usage: %s [--nodes N] [--channels N] [--groups N] [--max-associations N] [--fill RATIO]\n", argv[0] );
+        return 1;
+    }
+
+    std::mt19937 random( 42 );
+
+    DevicesModel model;
+    fillNetwork( model, parameters, random );
+
+    benchmarkLayouts( parameters, model );
+
+    std::unique_ptr<SourceModel> sourceModel;
+    std::unique_ptr<HintSourceModel> hintModel;
+
+    auto residentBefore = residentBytes();
+    const auto sourceMs = measureMs( [&]() {
+        sourceModel = std::make_unique<SourceModel>( model );
+    } );
+    printResult( parameters, "source_model_construction", sourceModel->getAssociationsCount(), sourceMs );
+    printMemoryResult( parameters, "source_model_resident_growth", sourceModel->getAssociationsCount(),
+                       residentBefore < 0 ? -1 : residentBytes() - residentBefore );
+
+    // what the same rows took before they were packed
+    printMemoryResult( parameters, "source_model_rows_packed", sourceModel->getAssociationsCount(),
+                       static_cast<long long>( sourceModel->getAssociationsCount() * sizeof(PackedAssociationInfo) ) );
+    printMemoryResult( parameters, "source_model_rows_unpacked", sourceModel->getAssociationsCount(),
+                       static_cast<long long>( sourceModel->getAssociationsCount() * sizeof(AssociationInfo) ) );
+
+    residentBefore = residentBytes();
+    const auto hintMs = measureMs( [&]() {
+        hintModel = std::make_unique<HintSourceModel>( model );
+    } );
+    printResult( parameters, "hint_model_construction", hintModel->getAssociationsCount(), hintMs );
+    printMemoryResult( parameters, "hint_model_resident_growth", hintModel->getAssociationsCount(),
+                       residentBefore < 0 ? -1 : residentBytes() - residentBefore );
+
+    benchmarkFilters( parameters, "existing", sourceModel.get() );
+    benchmarkFilters( parameters, "hint", hintModel.get() );
+
+    benchmarkFilterPredicates( parameters, "existing", sourceModel.get() );
+    benchmarkFilterPredicates( parameters, "hint", hintModel.get() );
+
+    benchmarkScrolling( parameters, "existing", sourceModel.get() );
+    benchmarkScrolling( parameters, "hint", hintModel.get() );
+
+    benchmarkRanking( parameters, hintModel.get() );
+
+    benchmarkCandidates( parameters );
+
+    benchmarkRoundTrips( parameters, model, *sourceModel, *hintModel, random );
+
+    benchmarkSnapshot( parameters, model );
+
+    return 0;
+}
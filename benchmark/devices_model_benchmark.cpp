@@ -0,0 +1,35 @@
+#include "devices_model.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+void benchmarkAddDevices(size_t devicesNumber) {
+    DevicesModel model;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for ( size_t index = 0; index < devicesNumber; ++index ) {
+        DevicesModel::Device device;
+        device.name = "Device";
+
+        model.addDevice( std::move( device ) );
+    }
+
+    const auto elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+
+    std::printf( "{\"benchmark\": \"add_device_auto_node_id\", \"devices\": %zu, \"total_ms\": %.3f, \"ns_per_device\": %.1f}\n",
+                 devicesNumber, elapsed / 1e6, elapsed / devicesNumber );
+}
+
+}
+
+int main()
+{
+    for ( size_t devicesNumber : { 500, 1000, 2000, 4000 } ) {
+        benchmarkAddDevices( devicesNumber );
+    }
+
+    return 0;
+}
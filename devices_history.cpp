@@ -0,0 +1,73 @@
+#include "devices_history.h"
+#include "devices_version.h"
+
+DevicesHistory::DevicesHistory(DevicesModel& model) :
+    m_model(model)
+{
+    m_currentVersion = m_model.getVersion();
+
+    m_changesListenerId = m_model.addChangesListener( [this](const std::vector<DevicesModel::Change>& changes) {
+        applyChanges( changes );
+    } );
+}
+
+DevicesHistory::~DevicesHistory() {
+    m_model.removeChangesListener( m_changesListenerId );
+}
+
+bool DevicesHistory::canUndo() const {
+    return !m_undoVersions.empty();
+}
+
+bool DevicesHistory::canRedo() const {
+    return !m_redoVersions.empty();
+}
+
+bool DevicesHistory::undo() {
+    return restore( m_undoVersions, m_redoVersions );
+}
+
+bool DevicesHistory::redo() {
+    return restore( m_redoVersions, m_undoVersions );
+}
+
+void DevicesHistory::applyChanges(const std::vector<DevicesModel::Change>& changes) {
+    // the edits of a restore are not steps of their own
+    if ( m_restoring )
+        return;
+
+    for ( const auto& change : changes ) {
+        if ( change.type == DevicesModel::Change::DeviceAdded || change.type == DevicesModel::Change::DeviceRemoved ) {
+            m_undoVersions.clear();
+            m_redoVersions.clear();
+            m_currentVersion = m_model.getVersion();
+
+            return;
+        }
+    }
+
+    m_undoVersions.push_back( std::move( m_currentVersion ) );
+    if ( m_undoVersions.size() > MaxStepsNumber )
+        m_undoVersions.pop_front();
+
+    m_redoVersions.clear();
+    m_currentVersion = m_model.getVersion();
+}
+
+bool DevicesHistory::restore(Versions& from, Versions& to) {
+    if ( from.empty() )
+        return false;
+
+    m_restoring = true;
+    const bool restored = m_model.restoreVersion( *from.back() );
+    m_restoring = false;
+
+    if ( !restored )
+        return false;
+
+    from.pop_back();
+    to.push_back( std::move( m_currentVersion ) );
+    m_currentVersion = m_model.getVersion();
+
+    return true;
+}
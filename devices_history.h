@@ -0,0 +1,46 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "devices_model.h"
+
+class DevicesVersion;
+
+// Undo and redo of association edits. Every notification of the model (one edit, or a committed batch)
+// is one step, kept as the version of the network before it; versions share all groups but the edited ones.
+// Adding or removing devices changes device positions, so it clears the history.
+class DevicesHistory
+{
+public:
+    DevicesHistory(DevicesModel& model);
+    ~DevicesHistory();
+
+    bool canUndo() const;
+
+    bool canRedo() const;
+
+    bool undo();
+
+    bool redo();
+
+    // Older steps are dropped.
+    static constexpr size_t MaxStepsNumber = 1000;
+
+private:
+    using Versions = std::deque<std::shared_ptr<const DevicesVersion>>;
+
+    void applyChanges(const std::vector<DevicesModel::Change>& changes);
+
+    bool restore(Versions& from, Versions& to);
+
+private:
+    DevicesModel& m_model;
+    size_t m_changesListenerId = 0;
+
+    std::shared_ptr<const DevicesVersion> m_currentVersion;
+    Versions m_undoVersions;
+    Versions m_redoVersions;
+    bool m_restoring = false;
+};
@@ -0,0 +1,182 @@
+#include "devices_importer.h"
+#include "devices_json.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+namespace {
+
+constexpr qint64 ChunkSize = 1 << 16;
+
+bool isJsonWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+}
+
+DevicesImporter::DevicesImporter(QString fileName, QObject* parent) :
+    QObject(parent),
+    m_fileName(std::move(fileName))
+{
+}
+
+DevicesImporter::~DevicesImporter() {
+    cancel();
+
+    if ( m_thread.joinable() )
+        m_thread.join();
+}
+
+void DevicesImporter::start() {
+    m_thread = std::thread( [this]() {
+        run();
+        emit finished();
+    } );
+}
+
+void DevicesImporter::cancel() {
+    m_cancelled = true;
+}
+
+bool DevicesImporter::isCancelled() const {
+    return m_cancelled;
+}
+
+const QString& DevicesImporter::getError() const {
+    return m_error;
+}
+
+std::vector<DevicesModel::Device> DevicesImporter::takeDevices() {
+    if ( m_thread.joinable() )
+        m_thread.join();
+
+    return std::move( m_devices );
+}
+
+void DevicesImporter::run() {
+    QFile file(m_fileName);
+
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        m_error = "Cannot open " + m_fileName;
+        return;
+    }
+
+    const qint64 fileSize = file.size();
+    qint64 processedSize = 0;
+    int percent = -1;
+
+    bool arrayStarted = false;
+    bool arrayFinished = false;
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    QByteArray element;
+
+    while ( !file.atEnd() ) {
+        if ( m_cancelled )
+            return;
+
+        const QByteArray chunk = file.read( ChunkSize );
+        int elementStart = depth > 1 ? 0 : -1;
+
+        for ( int position = 0; position < chunk.size(); ++position ) {
+            const char c = chunk[position];
+
+            if ( depth <= 1 ) {
+                if ( isJsonWhitespace( c ) || ( c == ',' && arrayStarted && !arrayFinished ) )
+                    continue;
+
+                if ( !arrayStarted && c == '[' ) {
+                    arrayStarted = true;
+                    depth = 1;
+                }
+                else if ( arrayStarted && !arrayFinished && c == ']' ) {
+                    arrayFinished = true;
+                    depth = 0;
+                }
+                else if ( arrayStarted && !arrayFinished && c == '{' ) {
+                    depth = 2;
+                    elementStart = position;
+                }
+                else {
+                    m_error = !arrayStarted ? QString( "The file must contain a JSON array of devices" ) :
+                                              arrayFinished ? QString( "Unexpected data after the array of devices" ) :
+                                                              "Device #" + QString::number( m_devices.size() + 1 ) + " is not a JSON object";
+                    return;
+                }
+
+                continue;
+            }
+
+            if ( inString ) {
+                if ( escaped )
+                    escaped = false;
+                else if ( c == '\\' )
+                    escaped = true;
+                else if ( c == '"' )
+                    inString = false;
+
+                continue;
+            }
+
+            if ( c == '"' ) {
+                inString = true;
+            }
+            else if ( c == '{' || c == '[' ) {
+                ++depth;
+            }
+            else if ( c == '}' || c == ']' ) {
+                if ( --depth == 1 ) {
+                    element.append( chunk.constData() + elementStart, position + 1 - elementStart );
+                    elementStart = -1;
+
+                    if ( !addDevice( element ) )
+                        return;
+
+                    element.clear();
+                }
+            }
+        }
+
+        if ( elementStart >= 0 ) {
+            element.append( chunk.constData() + elementStart, chunk.size() - elementStart );
+        }
+
+        processedSize += chunk.size();
+
+        const int newPercent = fileSize > 0 ? static_cast<int>( processedSize * 100 / fileSize ) : 100;
+        if ( newPercent != percent ) {
+            percent = newPercent;
+            emit progressChanged( percent );
+        }
+    }
+
+    if ( !arrayFinished ) {
+        m_error = "Unexpected end of file";
+    }
+}
+
+bool DevicesImporter::addDevice(const QByteArray& json) {
+    QJsonParseError parseError;
+    auto jsonDoc = QJsonDocument::fromJson( json, &parseError );
+
+    QString error;
+    DevicesModel::Device device;
+
+    if ( parseError.error != QJsonParseError::NoError ) {
+        error = parseError.errorString();
+    }
+    else {
+        parseDeviceJson( jsonDoc.object(), device, error );
+    }
+
+    if ( !error.isEmpty() ) {
+        m_error = "Device #" + QString::number( m_devices.size() + 1 ) + ": " + error;
+        return false;
+    }
+
+    m_devices.push_back( std::move( device ) );
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "devices_model.h"
+
+// Reads a JSON array of devices on a worker thread. Elements are split out of the file chunk by chunk
+// and parsed one at a time, so memory is bounded by the largest device, not by the file.
+// Nothing is committed to the model here: the caller takes the validated devices after finished().
+class DevicesImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    DevicesImporter(QString fileName, QObject* parent = nullptr);
+    ~DevicesImporter();
+
+    void start();
+
+    void cancel();
+
+    bool isCancelled() const;
+
+    const QString& getError() const;
+
+    std::vector<DevicesModel::Device> takeDevices();
+
+signals:
+    void progressChanged(int percent);
+
+    void finished();
+
+private:
+    void run();
+
+    bool addDevice(const QByteArray& json);
+
+private:
+    QString m_fileName;
+    std::thread m_thread;
+    std::atomic<bool> m_cancelled{ false };
+
+    QString m_error;
+    std::vector<DevicesModel::Device> m_devices;
+};
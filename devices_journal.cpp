@@ -0,0 +1,344 @@
+#include "devices_journal.h"
+#include "devices_snapshot.h"
+#include "devices_version.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char Magic[8] = { 'A', 'S', 'S', 'O', 'C', 'J', 'R', 'N' };
+constexpr uint32_t Version = 1;
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr uint32_t NoChannel = UINT32_MAX;
+
+// FNV-1a over the record without the checksum field; a torn write at the end of the journal fails it.
+uint32_t computeChecksum(const DevicesJournal::Record& record) {
+    const auto bytes = reinterpret_cast<const unsigned char*>( &record );
+    uint32_t hash = 2166136261u;
+
+    for ( size_t index = 0; index < offsetof( DevicesJournal::Record, checksum ); ++index ) {
+        hash = ( hash ^ bytes[index] ) * 16777619u;
+    }
+
+    return hash;
+}
+
+bool syncFile(QFile& file) {
+    if ( !file.flush() )
+        return false;
+
+#ifdef Q_OS_WIN
+    return _commit( file.handle() ) == 0;
+#else
+    return fsync( file.handle() ) == 0;
+#endif
+}
+
+bool applyRecord(std::vector<DevicesModel::Device>& devices, const DevicesJournal::Record& record) {
+    if ( record.deviceIndex >= devices.size() ||
+         record.channelIndex >= devices[record.deviceIndex].channelsToGroups.size() ||
+         record.groupIndex >= devices[record.deviceIndex].channelsToGroups[record.channelIndex].size() )
+        return false;
+
+    auto& group = devices[record.deviceIndex].channelsToGroups[record.channelIndex][record.groupIndex];
+
+    const DevicesModel::Association association = { record.targetDeviceIndex,
+                                                    record.targetChannelIndex == NoChannel ? std::optional<size_t>() :
+                                                                                             std::optional<size_t>( record.targetChannelIndex ) };
+
+    switch ( record.type ) {
+    case DevicesModel::Change::AssociationAdded:
+        if ( record.targetDeviceIndex >= devices.size() )
+            return false;
+
+        group.associations.push_back( association );
+        return true;
+    case DevicesModel::Change::AssociationRemoved: {
+        auto it = std::find( group.associations.begin(), group.associations.end(), association );
+        if ( it == group.associations.end() )
+            return false;
+
+        group.associations.erase( it );
+        return true;
+    }
+    case DevicesModel::Change::GroupCapacityChanged:
+        if ( record.maxAssociationsNumber > UINT8_MAX )
+            return false;
+
+        group.maxAssociationsNumber = static_cast<uint8_t>( record.maxAssociationsNumber );
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
+DevicesJournal::DevicesJournal(DevicesModel& model) : m_model(model)
+{
+}
+
+DevicesJournal::~DevicesJournal() {
+    if ( !m_opened )
+        return;
+
+    m_model.removeChangesListener( m_changesListenerId );
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_stopping = true;
+    }
+
+    m_queueChanged.notify_one();
+    m_thread.join();
+}
+
+bool DevicesJournal::open(const QString& basePath, QString& error) {
+    if ( m_opened )
+        return false;
+
+    m_snapshotFileName = basePath + ".snapshot";
+    m_journalFile.setFileName( basePath + ".journal" );
+
+    const bool hasSnapshot = QFile::exists( m_snapshotFileName );
+    std::vector<DevicesModel::Device> devices;
+    uint64_t snapshotSequence = 0;
+
+    if ( hasSnapshot ) {
+        DevicesSnapshot snapshot;
+
+        if ( !snapshot.open( m_snapshotFileName, error ) )
+            return false;
+
+        devices = snapshot.readDevices();
+        snapshotSequence = snapshot.getJournalSequence();
+    }
+    else {
+        devices = m_model.getDevices();
+    }
+
+    if ( !m_journalFile.open( QIODevice::ReadWrite ) ) {
+        error = "Cannot open " + m_journalFile.fileName();
+        return false;
+    }
+
+    m_lastSequence = snapshotSequence;
+    qint64 validSize = 0;
+
+    Header header;
+    if ( m_journalFile.read( reinterpret_cast<char*>( &header ), sizeof(header) ) == sizeof(header) ) {
+        if ( std::memcmp( header.magic, Magic, sizeof(Magic) ) != 0 || header.version != Version || header.byteOrderMark != ByteOrderMark ) {
+            error = m_journalFile.fileName() + " is not a journal of this version";
+            m_journalFile.close();
+            return false;
+        }
+
+        validSize = sizeof(header);
+
+        // replay stops at the first torn, corrupted or out of order record; everything after it is dropped
+        Record record;
+        while ( m_journalFile.read( reinterpret_cast<char*>( &record ), sizeof(record) ) == sizeof(record) &&
+                record.checksum == computeChecksum( record ) ) {
+            if ( record.sequence > snapshotSequence ) {
+                if ( record.sequence != m_lastSequence + 1 || !applyRecord( devices, record ) )
+                    break;
+
+                m_lastSequence = record.sequence;
+            }
+
+            ++m_journalRecordsCount;
+            validSize += sizeof(record);
+        }
+    }
+
+    if ( validSize == 0 ) {
+        std::memcpy( header.magic, Magic, sizeof(Magic) );
+        header.version = Version;
+        header.byteOrderMark = ByteOrderMark;
+
+        m_journalFile.resize( 0 );
+        m_journalFile.seek( 0 );
+
+        if ( m_journalFile.write( reinterpret_cast<const char*>( &header ), sizeof(header) ) != sizeof(header) || !syncFile( m_journalFile ) ) {
+            error = m_journalFile.errorString();
+            m_journalFile.close();
+            return false;
+        }
+    }
+    else if ( !m_journalFile.resize( validSize ) || !m_journalFile.seek( validSize ) ) {
+        error = m_journalFile.errorString();
+        m_journalFile.close();
+        return false;
+    }
+
+    if ( !m_model.setDevices( std::move( devices ) ) ) {
+        error = m_snapshotFileName + " exceeds the network limits";
+        m_journalFile.close();
+        return false;
+    }
+
+    m_changesListenerId = m_model.addChangesListener( [this](const std::vector<DevicesModel::Change>& changes) {
+        applyChanges( changes );
+    } );
+
+    m_opened = true;
+    m_thread = std::thread( [this]() {
+        run();
+    } );
+
+    if ( !hasSnapshot )
+        compact();
+
+    return true;
+}
+
+void DevicesJournal::compact() {
+    if ( !m_opened )
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_pendingCompaction = Compaction{ m_model.getVersion(), m_lastSequence };
+    }
+
+    m_journalRecordsCount = 0;
+    m_queueChanged.notify_one();
+}
+
+void DevicesJournal::flush() {
+    if ( !m_opened )
+        return;
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_queueDrained.wait( lock, [this]() {
+        return m_pendingRecords.empty() && !m_pendingCompaction && !m_writing;
+    } );
+}
+
+QString DevicesJournal::getError() const {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_error;
+}
+
+void DevicesJournal::applyChanges(const std::vector<DevicesModel::Change>& changes) {
+    std::vector<Record> records;
+
+    for ( const auto& change : changes ) {
+        if ( change.type == DevicesModel::Change::DeviceAdded || change.type == DevicesModel::Change::DeviceRemoved ) {
+            compact();
+            return;
+        }
+
+        Record record = {};
+        record.sequence = m_lastSequence + records.size() + 1;
+        record.type = change.type;
+        record.deviceIndex = static_cast<uint32_t>( change.deviceIndex );
+        record.channelIndex = static_cast<uint32_t>( change.channelIndex );
+        record.groupIndex = static_cast<uint32_t>( change.groupIndex );
+        record.targetDeviceIndex = static_cast<uint32_t>( change.association.deviceIndex );
+        record.targetChannelIndex = change.association.channelIndex ? static_cast<uint32_t>( *change.association.channelIndex ) : NoChannel;
+
+        if ( change.type == DevicesModel::Change::GroupCapacityChanged )
+            record.maxAssociationsNumber = m_model.getDevices()[change.deviceIndex].channelsToGroups[change.channelIndex][change.groupIndex].maxAssociationsNumber;
+
+        record.checksum = computeChecksum( record );
+        records.push_back( record );
+    }
+
+    if ( records.empty() )
+        return;
+
+    m_lastSequence = records.back().sequence;
+    m_journalRecordsCount += records.size();
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_pendingRecords.insert( m_pendingRecords.end(), records.begin(), records.end() );
+    }
+
+    m_queueChanged.notify_one();
+
+    if ( m_journalRecordsCount >= CompactionThreshold )
+        compact();
+}
+
+void DevicesJournal::run() {
+    for ( ;; ) {
+        std::vector<Record> records;
+        std::optional<Compaction> compaction;
+
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_queueChanged.wait( lock, [this]() {
+                return m_stopping || !m_pendingRecords.empty() || m_pendingCompaction;
+            } );
+
+            if ( m_pendingRecords.empty() && !m_pendingCompaction )
+                return;
+
+            // everything queued since the previous commit is written and synced together
+            records.swap( m_pendingRecords );
+            compaction.swap( m_pendingCompaction );
+            m_writing = true;
+        }
+
+        if ( compaction )
+            writeCompaction( *compaction, records );
+        else
+            writeRecords( records );
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_writing = false;
+        }
+
+        m_queueDrained.notify_all();
+    }
+}
+
+bool DevicesJournal::writeRecords(const std::vector<Record>& records) {
+    const auto size = static_cast<qint64>( records.size() * sizeof(Record) );
+
+    if ( ( size > 0 && m_journalFile.write( reinterpret_cast<const char*>( records.data() ), size ) != size ) || !syncFile( m_journalFile ) ) {
+        setError( m_journalFile.errorString() );
+        return false;
+    }
+
+    return true;
+}
+
+bool DevicesJournal::writeCompaction(const Compaction& compaction, const std::vector<Record>& records) {
+    QString error;
+
+    if ( !DevicesSnapshot::save( *compaction.version, compaction.sequence, m_snapshotFileName, error ) ) {
+        setError( error );
+        return writeRecords( records );
+    }
+
+    // a crash before the journal is truncated is harmless: records up to the snapshot sequence are skipped on replay
+    if ( !m_journalFile.resize( sizeof(Header) ) || !m_journalFile.seek( sizeof(Header) ) ) {
+        setError( m_journalFile.errorString() );
+        return false;
+    }
+
+    std::vector<Record> newerRecords;
+    std::copy_if( records.begin(), records.end(), std::back_inserter( newerRecords ), [&compaction](const Record& record) {
+        return record.sequence > compaction.sequence;
+    } );
+
+    return writeRecords( newerRecords );
+}
+
+void DevicesJournal::setError(QString error) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_error = std::move( error );
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "devices_model.h"
+
+class DevicesVersion;
+
+// Keeps the network between runs in two files: <basePath>.snapshot is the last compacted network and
+// <basePath>.journal holds the association edits made since, as fixed-size checksummed records.
+// Edits are appended by a writer thread that fsyncs everything queued since its previous commit at once.
+// Device additions and removals are not journaled: they shift device positions, so they trigger a compaction,
+// which writes a fresh snapshot on the writer thread and empties the journal. The writer serializes a
+// structurally shared version of the network, so the GUI thread copies nothing for it.
+class DevicesJournal
+{
+public:
+    DevicesJournal(DevicesModel& model);
+    ~DevicesJournal();
+
+    // Loads the snapshot, replays the journal on top of it into the model and starts recording the model changes.
+    bool open(const QString& basePath, QString& error);
+
+    void compact();
+
+    // Blocks until everything recorded so far is on disk.
+    void flush();
+
+    QString getError() const;
+
+    // The journal is compacted once it holds this many records.
+    static constexpr size_t CompactionThreshold = 4096;
+
+public:
+    struct Record {
+        uint64_t sequence;
+        uint32_t type;
+        uint32_t deviceIndex;
+        uint32_t channelIndex;
+        uint32_t groupIndex;
+        uint32_t targetDeviceIndex;
+        uint32_t targetChannelIndex;
+        uint32_t maxAssociationsNumber;
+        uint32_t checksum;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+    };
+
+private:
+    struct Compaction {
+        std::shared_ptr<const DevicesVersion> version;
+        uint64_t sequence;
+    };
+
+    void applyChanges(const std::vector<DevicesModel::Change>& changes);
+
+    void run();
+
+    bool writeRecords(const std::vector<Record>& records);
+
+    bool writeCompaction(const Compaction& compaction, const std::vector<Record>& records);
+
+    void setError(QString error);
+
+private:
+    DevicesModel& m_model;
+    size_t m_changesListenerId = 0;
+    bool m_opened = false;
+
+    QString m_snapshotFileName;
+    QFile m_journalFile;
+
+    uint64_t m_lastSequence = 0;
+    size_t m_journalRecordsCount = 0;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::condition_variable m_queueDrained;
+    std::vector<Record> m_pendingRecords;
+    std::optional<Compaction> m_pendingCompaction;
+    bool m_writing = false;
+    bool m_stopping = false;
+    QString m_error;
+};
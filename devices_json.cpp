@@ -0,0 +1,54 @@
+#include "devices_json.h"
+
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+
+#include <limits>
+
+bool parseDeviceJson(const QJsonObject& object, DevicesModel::Device& device, QString& error) {
+    if ( !object["name"].isString() || object["name"].toString().isEmpty() ) {
+        error = "device name is missing";
+        return false;
+    }
+
+    device.name = object["name"].toString().toStdString();
+
+    for ( auto channel : object["channels"].toArray() ) {
+        std::vector< DevicesModel::AssociationGroup > associationGroups;
+
+        for ( auto group : channel.toObject()["groups"].toArray() ) {
+            auto groupObject = group.toObject();
+
+            if ( !groupObject["name"].isString() ) {
+                error = "association group name is missing";
+                return false;
+            }
+
+            const auto maxAssociationsNumber = groupObject["maxAssociationsNumber"].toInt();
+            if ( maxAssociationsNumber < 0 || maxAssociationsNumber > std::numeric_limits<uint8_t>::max() ) {
+                error = "maxAssociationsNumber of group \"" + groupObject["name"].toString() + "\" is out of range";
+                return false;
+            }
+
+            DevicesModel::AssociationGroup associationGroup;
+            associationGroup.name = groupObject["name"].toString().toStdString();
+            associationGroup.profile = groupObject["profile"].toString().toStdString();
+            associationGroup.maxAssociationsNumber = static_cast<uint8_t>( maxAssociationsNumber );
+
+            associationGroups.push_back( std::move( associationGroup ) );
+        }
+
+        device.channelsToGroups.push_back(std::move(associationGroups));
+    }
+
+    for ( auto subdeviceJson : object["subdevices"].toArray() ) {
+        DevicesModel::SubDeivice subdevice;
+
+        subdevice.name = subdeviceJson.toObject()["name"].toString().toStdString();
+
+        device.children.push_back( std::move( subdevice ) );
+    }
+
+    return true;
+}
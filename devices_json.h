@@ -0,0 +1,9 @@
+#pragma once
+
+#include "devices_model.h"
+
+#include <QString>
+
+class QJsonObject;
+
+bool parseDeviceJson(const QJsonObject& object, DevicesModel::Device& device, QString& error);
@@ -1,9 +1,54 @@
 #include "devices_model.h"
+#include "flat_associations.h"
+#include "devices_version.h"
 
 #include <algorithm>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+
+// an association of a group, as added or removed by a change
+struct AssociationChangeKey {
+    size_t deviceIndex;
+    size_t channelIndex;
+    size_t groupIndex;
+    size_t targetDeviceIndex;
+    // the whole node is 0, channel c is c + 1
+    size_t targetChannel;
+
+    explicit AssociationChangeKey(const DevicesModel::Change& change) :
+        deviceIndex(change.deviceIndex),
+        channelIndex(change.channelIndex),
+        groupIndex(change.groupIndex),
+        targetDeviceIndex(change.association.deviceIndex),
+        targetChannel(change.association.channelIndex ? *change.association.channelIndex + 1 : 0)
+    { }
+
+    bool operator == (const AssociationChangeKey& other) const {
+        return std::tie( deviceIndex, channelIndex, groupIndex, targetDeviceIndex, targetChannel ) ==
+               std::tie( other.deviceIndex, other.channelIndex, other.groupIndex, other.targetDeviceIndex, other.targetChannel );
+    }
+};
+
+struct AssociationChangeKeyHash {
+    size_t operator () (const AssociationChangeKey& key) const {
+        size_t result = 0;
+
+        for ( auto value : { key.deviceIndex, key.channelIndex, key.groupIndex, key.targetDeviceIndex, key.targetChannel } ) {
+            result = ( result ^ std::hash<size_t>()( value ) ) * 0x100000001b3ull;
+        }
+
+        return result;
+    }
+};
+
+}
 
 DevicesModel::DevicesModel()
 {
+    markNodeIdUsed( 0 );
+
     {
         Device device;
         device.nodeId = 1;
@@ -111,51 +156,737 @@ const std::vector<DevicesModel::Device>& DevicesModel::getDevices() const {
     return m_devices;
 }
 
-void DevicesModel::addDevice(Device device) {
+bool DevicesModel::addDevice(Device device) {
+    if ( m_devices.size() >= MaxDevicesNumber || !fitsLimits( device, m_devices.size() + 1 ) )
+        return false;
+
     if ( device.nodeId == 0 ) {
-        while (findDeviceByNode(++device.nodeId));
+        device.nodeId = allocateNodeId();
     }
 
+    markNodeIdUsed( device.nodeId );
+    m_nodeIdsToDevices.emplace( device.nodeId, m_devices.size() );
+
+    m_deviceSlots.push_back( acquireSlot( m_devices.size() ) );
+
     m_devices.push_back( std::move( device ) );
+
+    const size_t deviceIndex = m_devices.size() - 1;
+    const auto& channelsToGroups = m_devices.back().channelsToGroups;
+
+    for ( size_t channelIndex = 0; channelIndex < channelsToGroups.size(); ++channelIndex ) {
+        for ( size_t groupIndex = 0; groupIndex < channelsToGroups[channelIndex].size(); ++groupIndex ) {
+            for ( const auto& association : channelsToGroups[channelIndex][groupIndex].associations ) {
+                addIncomingAssociation( deviceIndex, channelIndex, groupIndex, association );
+            }
+        }
+    }
+
+    notify( { Change::DeviceAdded, deviceIndex } );
+
+    return true;
+}
+
+bool DevicesModel::addDevices(std::vector<Device> devices) {
+    if ( m_devices.size() + devices.size() > MaxDevicesNumber )
+        return false;
+
+    for ( size_t index = 0; index < devices.size(); ++index ) {
+        if ( !fitsLimits( devices[index], m_devices.size() + index + 1 ) )
+            return false;
+    }
+
+    m_devices.reserve( m_devices.size() + devices.size() );
+
+    suspendChanges();
+
+    for ( auto& device : devices ) {
+        addDevice( std::move( device ) );
+    }
+
+    resumeChanges();
+
+    return true;
+}
+
+bool DevicesModel::setDevices(std::vector<Device> devices) {
+    if ( m_associationsBatch || devices.size() > MaxDevicesNumber )
+        return false;
+
+    for ( const auto& device : devices ) {
+        if ( !fitsLimits( device, devices.size() ) )
+            return false;
+    }
+
+    suspendChanges();
+
+    // every device is replaced, so the version is built anew when it is next requested
+    m_version.reset();
+    m_staleGroups.clear();
+
+    for ( size_t deviceIndex = m_devices.size(); deviceIndex-- > 0; ) {
+        releaseSlot( m_deviceSlots[deviceIndex] );
+        notify( { Change::DeviceRemoved, deviceIndex } );
+    }
+
+    m_devices = std::move( devices );
+    m_deviceSlots.clear();
+    m_nodeIdsToDevices.clear();
+    std::fill( m_usedNodeIds.begin(), m_usedNodeIds.end(), 0 );
+    m_firstFreeNodeIdWord = 0;
+    markNodeIdUsed( 0 );
+
+    // explicit node ids are reserved first, so an allocated one never collides with a device further in the list
+    for ( const auto& device : m_devices ) {
+        markNodeIdUsed( device.nodeId );
+    }
+
+    for ( size_t deviceIndex = 0; deviceIndex < m_devices.size(); ++deviceIndex ) {
+        auto& device = m_devices[deviceIndex];
+
+        if ( device.nodeId == 0 ) {
+            device.nodeId = allocateNodeId();
+            markNodeIdUsed( device.nodeId );
+        }
+
+        m_nodeIdsToDevices.emplace( device.nodeId, deviceIndex );
+        m_deviceSlots.push_back( acquireSlot( deviceIndex ) );
+    }
+
+    for ( size_t deviceIndex = 0; deviceIndex < m_devices.size(); ++deviceIndex ) {
+        const auto& channelsToGroups = m_devices[deviceIndex].channelsToGroups;
+
+        for ( size_t channelIndex = 0; channelIndex < channelsToGroups.size(); ++channelIndex ) {
+            for ( size_t groupIndex = 0; groupIndex < channelsToGroups[channelIndex].size(); ++groupIndex ) {
+                for ( const auto& association : channelsToGroups[channelIndex][groupIndex].associations ) {
+                    addIncomingAssociation( deviceIndex, channelIndex, groupIndex, association );
+                }
+            }
+        }
+
+        notify( { Change::DeviceAdded, deviceIndex } );
+    }
+
+    resumeChanges();
+
+    return true;
+}
+
+DevicesModel::DeviceHandle DevicesModel::getDeviceHandle(size_t deviceIndex) const {
+    const auto slot = m_deviceSlots[deviceIndex];
+
+    return { slot, m_slots[slot].generation };
+}
+
+std::optional<size_t> DevicesModel::findDeviceIndex(DeviceHandle handle) const {
+    if ( handle.slot >= m_slots.size() )
+        return {};
+
+    const auto& slot = m_slots[handle.slot];
+
+    if ( !slot.used || slot.generation != handle.generation )
+        return {};
+
+    return slot.deviceIndex;
+}
+
+bool DevicesModel::removeDevice(DeviceHandle handle) {
+    const auto foundIndex = findDeviceIndex( handle );
+    if ( !foundIndex || m_associationsBatch )
+        return false;
+
+    const size_t deviceIndex = *foundIndex;
+    const size_t lastIndex = m_devices.size() - 1;
+
+    // groups whose associations are dropped or renumbered below, by source slot as the devices move
+    std::vector<std::tuple<uint32_t, size_t, size_t>> renumberedGroups;
+
+    if ( m_version ) {
+        // devices added since the version was last requested are appended first, so that positions match
+        if ( m_version->getDevicesCount() < m_devices.size() )
+            m_version = m_version->withDevices( m_devices, m_version->getDevicesCount() );
+
+        for ( auto slot : { handle.slot, m_deviceSlots[lastIndex] } ) {
+            for ( const auto& bucket : m_incomingAssociations[slot] ) {
+                for ( const auto& incoming : bucket ) {
+                    renumberedGroups.emplace_back( incoming.sourceSlot, incoming.channelIndex, incoming.groupIndex );
+                }
+            }
+        }
+    }
+
+    {
+        const auto& channelsToGroups = m_devices[deviceIndex].channelsToGroups;
+
+        for ( size_t channelIndex = 0; channelIndex < channelsToGroups.size(); ++channelIndex ) {
+            for ( size_t groupIndex = 0; groupIndex < channelsToGroups[channelIndex].size(); ++groupIndex ) {
+                for ( const auto& association : channelsToGroups[channelIndex][groupIndex].associations ) {
+                    removeIncomingAssociation( deviceIndex, channelIndex, groupIndex, association );
+                }
+            }
+        }
+    }
+
+    for ( const auto& bucket : m_incomingAssociations[handle.slot] ) {
+        for ( const auto& incoming : bucket ) {
+            const size_t sourceIndex = m_slots[incoming.sourceSlot].deviceIndex;
+            auto& associations = m_devices[sourceIndex].channelsToGroups[incoming.channelIndex][incoming.groupIndex].associations;
+
+            auto it = std::find( associations.begin(), associations.end(), Association{ deviceIndex, incoming.targetChannelIndex } );
+            if ( it != associations.end() )
+                associations.erase( it );
+        }
+    }
+
+    auto nodeIt = m_nodeIdsToDevices.find( m_devices[deviceIndex].nodeId );
+    if ( nodeIt != m_nodeIdsToDevices.end() && nodeIt->second == deviceIndex ) {
+        m_nodeIdsToDevices.erase( nodeIt );
+        markNodeIdFree( m_devices[deviceIndex].nodeId );
+    }
+
+    if ( deviceIndex != lastIndex ) {
+        const uint32_t movedSlot = m_deviceSlots[lastIndex];
+
+        for ( const auto& bucket : m_incomingAssociations[movedSlot] ) {
+            for ( const auto& incoming : bucket ) {
+                const size_t sourceIndex = m_slots[incoming.sourceSlot].deviceIndex;
+                auto& associations = m_devices[sourceIndex].channelsToGroups[incoming.channelIndex][incoming.groupIndex].associations;
+
+                auto it = std::find( associations.begin(), associations.end(), Association{ lastIndex, incoming.targetChannelIndex } );
+                if ( it != associations.end() )
+                    it->deviceIndex = deviceIndex;
+            }
+        }
+
+        auto movedNodeIt = m_nodeIdsToDevices.find( m_devices[lastIndex].nodeId );
+        if ( movedNodeIt != m_nodeIdsToDevices.end() && movedNodeIt->second == lastIndex )
+            movedNodeIt->second = deviceIndex;
+
+        m_devices[deviceIndex] = std::move( m_devices[lastIndex] );
+        m_deviceSlots[deviceIndex] = movedSlot;
+        m_slots[movedSlot].deviceIndex = deviceIndex;
+    }
+
+    m_devices.pop_back();
+    m_deviceSlots.pop_back();
+
+    releaseSlot( handle.slot );
+
+    // the version follows the move with a few path copies; the renumbered groups are copied when it is next requested
+    if ( m_version ) {
+        m_version = m_version->withoutDevice( deviceIndex );
+
+        std::vector<GroupKey> staleGroups;
+        staleGroups.reserve( m_staleGroups.size() + renumberedGroups.size() );
+
+        for ( auto key : m_staleGroups ) {
+            if ( key.deviceIndex == deviceIndex )
+                continue;
+
+            if ( key.deviceIndex == lastIndex )
+                key.deviceIndex = deviceIndex;
+
+            staleGroups.push_back( key );
+        }
+
+        for ( const auto& [sourceSlot, channelIndex, groupIndex] : renumberedGroups ) {
+            if ( sourceSlot != handle.slot )
+                staleGroups.push_back( { m_slots[sourceSlot].deviceIndex, channelIndex, groupIndex } );
+        }
+
+        m_staleGroups = std::move( staleGroups );
+
+        if ( m_staleGroups.size() > m_devices.size() + DevicesVersion::ChunkSize ) {
+            m_version.reset();
+            m_staleGroups.clear();
+        }
+    }
+
+    notify( { Change::DeviceRemoved, deviceIndex } );
+
+    return true;
 }
 
-void DevicesModel::removeAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association) {
+bool DevicesModel::removeAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association) {
     if ( m_devices.size() <= deviceIndex )
-        return;
+        return rejectAssociationEdit( UnknownGroup );
 
     if ( m_devices[deviceIndex].channelsToGroups.size() <= channelIndex )
-        return;
+        return rejectAssociationEdit( UnknownGroup );
 
     if ( m_devices[deviceIndex].channelsToGroups[channelIndex].size() <= groupIndex )
-        return;
+        return rejectAssociationEdit( UnknownGroup );
 
     auto& associations = m_devices[deviceIndex].channelsToGroups[channelIndex][groupIndex].associations;
 
-    associations.erase(std::find(associations.begin(), associations.end(), association));
+    auto it = std::find(associations.begin(), associations.end(), association);
+    if ( it == associations.end() )
+        return rejectAssociationEdit( MissingAssociation );
+
+    if ( m_associationsBatch )
+        m_associationsBatch->appliedEdits.push_back( { false, deviceIndex, channelIndex, groupIndex, static_cast<size_t>( it - associations.begin() ), association } );
+
+    associations.erase(it);
+    removeIncomingAssociation( deviceIndex, channelIndex, groupIndex, association );
+
+    notify( { Change::AssociationRemoved, deviceIndex, channelIndex, groupIndex, association } );
+
+    return true;
 }
 
-void DevicesModel::addAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association) {
+bool DevicesModel::addAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association) {
     if ( m_devices.size() <= deviceIndex )
-        return;
+        return rejectAssociationEdit( UnknownGroup );
 
     if ( m_devices[deviceIndex].channelsToGroups.size() <= channelIndex )
-        return;
+        return rejectAssociationEdit( UnknownGroup );
 
     if ( m_devices[deviceIndex].channelsToGroups[channelIndex].size() <= groupIndex )
-        return;
+        return rejectAssociationEdit( UnknownGroup );
 
     if ( m_devices[deviceIndex].channelsToGroups[channelIndex][groupIndex].associations.size() >=
          m_devices[deviceIndex].channelsToGroups[channelIndex][groupIndex].maxAssociationsNumber )
+        return rejectAssociationEdit( GroupFull );
+
+    if ( association.deviceIndex >= m_devices.size() || ( association.channelIndex && *association.channelIndex >= MaxChannelsNumber ) )
+        return rejectAssociationEdit( UnknownTarget );
+
+    auto& associations = m_devices[deviceIndex].channelsToGroups[channelIndex][groupIndex].associations;
+
+    if ( m_associationsBatch )
+        m_associationsBatch->appliedEdits.push_back( { true, deviceIndex, channelIndex, groupIndex, associations.size(), association } );
+
+    associations.push_back( association );
+    addIncomingAssociation( deviceIndex, channelIndex, groupIndex, association );
+
+    notify( { Change::AssociationAdded, deviceIndex, channelIndex, groupIndex, association } );
+
+    return true;
+}
+
+bool DevicesModel::rejectAssociationEdit(AssociationRejection rejection) {
+    if ( m_associationsBatch && m_associationsBatch->rejection == NoRejection )
+        m_associationsBatch->rejection = rejection;
+
+    return false;
+}
+
+void DevicesModel::beginAssociationsBatch() {
+    if ( m_associationsBatch )
+        return;
+
+    m_associationsBatch.emplace();
+    m_associationsBatch->firstChange = m_pendingChanges.size();
+
+    suspendChanges();
+}
+
+bool DevicesModel::commitAssociationsBatch() {
+    AssociationRejection rejection;
+    return commitAssociationsBatch( rejection );
+}
+
+bool DevicesModel::commitAssociationsBatch(AssociationRejection& rejection) {
+    rejection = NoRejection;
+
+    if ( !m_associationsBatch )
+        return false;
+
+    if ( m_associationsBatch->rejection != NoRejection ) {
+        rejection = m_associationsBatch->rejection;
+        rollbackAssociationsBatch();
+        return false;
+    }
+
+    m_associationsBatch.reset();
+    resumeChanges();
+
+    return true;
+}
+
+void DevicesModel::rollbackAssociationsBatch() {
+    if ( !m_associationsBatch )
         return;
 
+    m_flatAssociations.reset();
+
+    auto appliedEdits = std::move( m_associationsBatch->appliedEdits );
+    m_pendingChanges.resize( m_associationsBatch->firstChange );
+    m_associationsBatch.reset();
+
+    for ( auto it = appliedEdits.rbegin(); it != appliedEdits.rend(); ++it ) {
+        auto& associations = m_devices[it->deviceIndex].channelsToGroups[it->channelIndex][it->groupIndex].associations;
+
+        if ( it->added ) {
+            associations.erase( associations.begin() + it->position );
+            removeIncomingAssociation( it->deviceIndex, it->channelIndex, it->groupIndex, it->association );
+        }
+        else {
+            associations.insert( associations.begin() + it->position, it->association );
+            addIncomingAssociation( it->deviceIndex, it->channelIndex, it->groupIndex, it->association );
+        }
+    }
+
+    resumeChanges();
+}
+
+bool DevicesModel::setMaxAssociationsNumber(size_t deviceIndex, size_t channelIndex, size_t groupIndex, uint8_t maxAssociationsNumber) {
+    if ( m_devices.size() <= deviceIndex ||
+         m_devices[deviceIndex].channelsToGroups.size() <= channelIndex ||
+         m_devices[deviceIndex].channelsToGroups[channelIndex].size() <= groupIndex )
+        return false;
+
+    auto& group = m_devices[deviceIndex].channelsToGroups[channelIndex][groupIndex];
+
+    if ( group.associations.size() > maxAssociationsNumber )
+        return false;
+
+    if ( group.maxAssociationsNumber != maxAssociationsNumber ) {
+        group.maxAssociationsNumber = maxAssociationsNumber;
+        notify( { Change::GroupCapacityChanged, deviceIndex, channelIndex, groupIndex } );
+    }
+
+    return true;
+}
+
+size_t DevicesModel::addChangesListener(ChangesListener listener) {
+    const auto listenerId = m_nextChangesListenerId++;
+    m_changesListeners.emplace( listenerId, std::move( listener ) );
+
+    return listenerId;
+}
 
-    m_devices[deviceIndex].channelsToGroups[channelIndex][groupIndex].associations.push_back( association );
+void DevicesModel::removeChangesListener(size_t listenerId) {
+    m_changesListeners.erase( listenerId );
 }
 
 const DevicesModel::Device* DevicesModel::findDeviceByNode(size_t nodeIndex) const {
-    auto it = std::find_if( m_devices.begin(), m_devices.end(), [nodeIndex](const Device& device) {
-        return device.nodeId == nodeIndex;
+    auto it = m_nodeIdsToDevices.find( nodeIndex );
+
+    return it == m_nodeIdsToDevices.end() ? nullptr : &m_devices[it->second];
+}
+
+const FlatAssociations& DevicesModel::getFlatAssociations() const {
+    if ( !m_flatAssociations )
+        m_flatAssociations = std::make_shared<const FlatAssociations>( m_devices );
+
+    return *m_flatAssociations;
+}
+
+std::shared_ptr<const FlatAssociations> DevicesModel::getFlatAssociationsSnapshot() const {
+    getFlatAssociations();
+
+    return m_flatAssociations;
+}
+
+std::shared_ptr<const DevicesVersion> DevicesModel::getVersion() const {
+    if ( !m_version ) {
+        m_version = std::make_shared<const DevicesVersion>( m_devices );
+        m_staleGroups.clear();
+
+        return m_version;
+    }
+
+    if ( m_version->getDevicesCount() < m_devices.size() )
+        m_version = m_version->withDevices( m_devices, m_version->getDevicesCount() );
+
+    // a group edited several times, or edited and rolled back, is copied once with its current content
+    std::sort( m_staleGroups.begin(), m_staleGroups.end(), [](const GroupKey& left, const GroupKey& right) {
+        return std::tie( left.deviceIndex, left.channelIndex, left.groupIndex ) < std::tie( right.deviceIndex, right.channelIndex, right.groupIndex );
+    } );
+
+    for ( size_t index = 0; index < m_staleGroups.size(); ++index ) {
+        const auto& key = m_staleGroups[index];
+
+        if ( index > 0 && key.deviceIndex == m_staleGroups[index - 1].deviceIndex && key.channelIndex == m_staleGroups[index - 1].channelIndex &&
+             key.groupIndex == m_staleGroups[index - 1].groupIndex )
+            continue;
+
+        m_version = m_version->withGroup( key.deviceIndex, key.channelIndex, key.groupIndex,
+                                          m_devices[key.deviceIndex].channelsToGroups[key.channelIndex][key.groupIndex] );
+    }
+
+    m_staleGroups.clear();
+
+    return m_version;
+}
+
+bool DevicesModel::restoreVersion(const DevicesVersion& version) {
+    if ( m_associationsBatch )
+        return false;
+
+    std::vector<GroupKey> groups;
+    if ( !getVersion()->findChangedGroups( version, groups ) )
+        return false;
+
+    // capacities only grow inside the batch, so that every association of the version fits, and shrink after it
+    std::vector<std::pair<GroupKey, uint8_t>> grownCapacities;
+
+    beginAssociationsBatch();
+
+    for ( const auto& key : groups ) {
+        const auto& target = version.getGroup( key.deviceIndex, key.channelIndex, key.groupIndex );
+        const auto& group = m_devices[key.deviceIndex].channelsToGroups[key.channelIndex][key.groupIndex];
+
+        if ( target.maxAssociationsNumber > group.maxAssociationsNumber ) {
+            grownCapacities.push_back( { key, group.maxAssociationsNumber } );
+            setMaxAssociationsNumber( key.deviceIndex, key.channelIndex, key.groupIndex, target.maxAssociationsNumber );
+        }
+
+        // the common prefix stays, the rest is replaced so that the order of the version comes back too
+        size_t prefix = 0;
+        while ( prefix < group.associations.size() && prefix < target.associations.size() &&
+                group.associations[prefix] == target.associations[prefix] ) {
+            ++prefix;
+        }
+
+        while ( group.associations.size() > prefix ) {
+            removeAssociation( key.deviceIndex, key.channelIndex, key.groupIndex, group.associations.back() );
+        }
+
+        for ( size_t index = prefix; index < target.associations.size(); ++index ) {
+            addAssociation( key.deviceIndex, key.channelIndex, key.groupIndex, target.associations[index] );
+        }
+    }
+
+    if ( !commitAssociationsBatch() ) {
+        for ( const auto& [key, maxAssociationsNumber] : grownCapacities ) {
+            setMaxAssociationsNumber( key.deviceIndex, key.channelIndex, key.groupIndex, maxAssociationsNumber );
+        }
+
+        return false;
+    }
+
+    for ( const auto& key : groups ) {
+        setMaxAssociationsNumber( key.deviceIndex, key.channelIndex, key.groupIndex,
+                                  version.getGroup( key.deviceIndex, key.channelIndex, key.groupIndex ).maxAssociationsNumber );
+    }
+
+    return true;
+}
+
+std::vector<DevicesModel::AssociationSource> DevicesModel::getIncomingAssociations(size_t targetDeviceIndex) const {
+    std::vector<AssociationSource> result;
+
+    if ( targetDeviceIndex >= m_devices.size() )
+        return result;
+
+    const auto slot = m_deviceSlots[targetDeviceIndex];
+
+    appendIncomingAssociations( slot, {}, result );
+
+    for ( size_t channelIndex = 0; channelIndex + 1 < m_incomingAssociations[slot].size(); ++channelIndex ) {
+        appendIncomingAssociations( slot, channelIndex, result );
+    }
+
+    return result;
+}
+
+std::vector<DevicesModel::AssociationSource> DevicesModel::getIncomingAssociations(size_t targetDeviceIndex, std::optional<size_t> targetChannelIndex) const {
+    std::vector<AssociationSource> result;
+
+    if ( targetDeviceIndex < m_devices.size() )
+        appendIncomingAssociations( m_deviceSlots[targetDeviceIndex], targetChannelIndex, result );
+
+    return result;
+}
+
+bool DevicesModel::fitsLimits(const Device& device, size_t devicesNumber) {
+    if ( device.channelsToGroups.size() > MaxChannelsNumber )
+        return false;
+
+    for ( const auto& groups : device.channelsToGroups ) {
+        if ( groups.size() > MaxGroupsNumber )
+            return false;
+
+        for ( const auto& group : groups ) {
+            for ( const auto& association : group.associations ) {
+                if ( association.deviceIndex >= devicesNumber || ( association.channelIndex && *association.channelIndex >= MaxChannelsNumber ) )
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+uint32_t DevicesModel::acquireSlot(size_t deviceIndex) {
+    uint32_t slot;
+    if ( !m_freeSlots.empty() ) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<uint32_t>( m_slots.size() );
+        m_slots.emplace_back();
+        m_incomingAssociations.emplace_back();
+    }
+
+    m_slots[slot].deviceIndex = deviceIndex;
+    m_slots[slot].used = true;
+
+    return slot;
+}
+
+void DevicesModel::releaseSlot(uint32_t slot) {
+    m_slots[slot].used = false;
+    ++m_slots[slot].generation;
+    m_incomingAssociations[slot].clear();
+    m_freeSlots.push_back( slot );
+}
+
+size_t DevicesModel::allocateNodeId() {
+    for ( ; m_firstFreeNodeIdWord < m_usedNodeIds.size(); ++m_firstFreeNodeIdWord ) {
+        const uint64_t freeBits = ~m_usedNodeIds[m_firstFreeNodeIdWord];
+
+        if ( freeBits != 0 ) {
+            size_t bit = 0;
+            while ( ( freeBits >> bit & 1 ) == 0 ) {
+                ++bit;
+            }
+
+            const size_t nodeId = m_firstFreeNodeIdWord * 64 + bit;
+            if ( nodeId <= MaxNodeId ) {
+                return nodeId;
+            }
+        }
+    }
+
+    size_t nodeId = MaxNodeId;
+    while (findDeviceByNode(++nodeId));
+
+    return nodeId;
+}
+
+void DevicesModel::markNodeIdUsed(size_t nodeId) {
+    if ( nodeId <= MaxNodeId ) {
+        m_usedNodeIds[nodeId / 64] |= uint64_t( 1 ) << ( nodeId % 64 );
+    }
+}
+
+void DevicesModel::markNodeIdFree(size_t nodeId) {
+    if ( nodeId > 0 && nodeId <= MaxNodeId ) {
+        m_usedNodeIds[nodeId / 64] &= ~( uint64_t( 1 ) << ( nodeId % 64 ) );
+        m_firstFreeNodeIdWord = std::min( m_firstFreeNodeIdWord, nodeId / 64 );
+    }
+}
+
+void DevicesModel::addIncomingAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, const Association& association) {
+    if ( association.deviceIndex >= m_devices.size() )
+        return;
+
+    auto& buckets = m_incomingAssociations[m_deviceSlots[association.deviceIndex]];
+    const size_t bucketIndex = association.channelIndex ? *association.channelIndex + 1 : 0;
+
+    if ( buckets.size() <= bucketIndex )
+        buckets.resize( bucketIndex + 1 );
+
+    buckets[bucketIndex].push_back( { m_deviceSlots[deviceIndex], channelIndex, groupIndex, association.channelIndex } );
+}
+
+void DevicesModel::removeIncomingAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, const Association& association) {
+    if ( association.deviceIndex >= m_devices.size() )
+        return;
+
+    auto& buckets = m_incomingAssociations[m_deviceSlots[association.deviceIndex]];
+    const size_t bucketIndex = association.channelIndex ? *association.channelIndex + 1 : 0;
+
+    if ( buckets.size() <= bucketIndex )
+        return;
+
+    auto& incomingAssociations = buckets[bucketIndex];
+    const auto sourceSlot = m_deviceSlots[deviceIndex];
+
+    auto it = std::find_if( incomingAssociations.begin(), incomingAssociations.end(), [&](const IncomingAssociation& incoming) {
+        return incoming.sourceSlot == sourceSlot && incoming.channelIndex == channelIndex && incoming.groupIndex == groupIndex;
     } );
 
-    return it == m_devices.end() ? nullptr : &*it;
+    if ( it != incomingAssociations.end() ) {
+        *it = incomingAssociations.back();
+        incomingAssociations.pop_back();
+    }
+}
+
+void DevicesModel::appendIncomingAssociations(uint32_t slot, std::optional<size_t> targetChannelIndex, std::vector<AssociationSource>& result) const {
+    const auto& buckets = m_incomingAssociations[slot];
+    const size_t bucketIndex = targetChannelIndex ? *targetChannelIndex + 1 : 0;
+
+    if ( buckets.size() <= bucketIndex )
+        return;
+
+    for ( const auto& incoming : buckets[bucketIndex] ) {
+        result.push_back( { m_slots[incoming.sourceSlot].deviceIndex, incoming.channelIndex, incoming.groupIndex, incoming.targetChannelIndex } );
+    }
+}
+
+void DevicesModel::notify(Change change) {
+    m_flatAssociations.reset();
+
+    // appended devices are added to the version when it is next requested, removals update it themselves
+    if ( m_version && change.type != Change::DeviceAdded && change.type != Change::DeviceRemoved ) {
+        m_staleGroups.push_back( { change.deviceIndex, change.channelIndex, change.groupIndex } );
+
+        // past this many path copies building the version anew is cheaper
+        if ( m_staleGroups.size() > m_devices.size() + DevicesVersion::ChunkSize ) {
+            m_version.reset();
+            m_staleGroups.clear();
+        }
+    }
+
+    m_pendingChanges.push_back( change );
+
+    if ( m_changesSuspended == 0 )
+        resumeChanges();
+}
+
+void DevicesModel::suspendChanges() {
+    ++m_changesSuspended;
+}
+
+void DevicesModel::resumeChanges() {
+    if ( m_changesSuspended > 0 && --m_changesSuspended > 0 )
+        return;
+
+    if ( m_pendingChanges.empty() )
+        return;
+
+    auto changes = std::move( m_pendingChanges );
+    m_pendingChanges.clear();
+
+    std::vector<bool> cancelled( changes.size(), false );
+
+    // a removal cancels the latest add of the same association that is not cancelled yet
+    std::unordered_map<AssociationChangeKey, std::vector<size_t>, AssociationChangeKeyHash> pendingAdds;
+
+    for ( size_t index = 0; index < changes.size(); ++index ) {
+        if ( changes[index].type == Change::AssociationAdded ) {
+            pendingAdds[AssociationChangeKey( changes[index] )].push_back( index );
+            continue;
+        }
+
+        if ( changes[index].type != Change::AssociationRemoved )
+            continue;
+
+        auto it = pendingAdds.find( AssociationChangeKey( changes[index] ) );
+        if ( it == pendingAdds.end() || it->second.empty() )
+            continue;
+
+        cancelled[it->second.back()] = true;
+        cancelled[index] = true;
+        it->second.pop_back();
+    }
+
+    std::vector<Change> coalescedChanges;
+    for ( size_t index = 0; index < changes.size(); ++index ) {
+        if ( !cancelled[index] )
+            coalescedChanges.push_back( changes[index] );
+    }
+
+    if ( coalescedChanges.empty() )
+        return;
+
+    auto listeners = m_changesListeners;
+    for ( const auto& [listenerId, listener] : listeners ) {
+        listener( coalescedChanges );
+    }
 }
@@ -5,6 +5,12 @@
 #include <cstdint>
 #include <optional>
 #include <map>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+
+struct FlatAssociations;
+class DevicesVersion;
 
 class DevicesModel
 {
@@ -50,21 +56,214 @@ public:
           std::vector<SubDeivice> children;
     };
 
+    // Stays valid while the device exists, regardless of its current position in getDevices().
+    struct DeviceHandle {
+        uint32_t slot = 0;
+        uint32_t generation = 0;
+
+        bool operator == (const DeviceHandle& other) const {
+            return slot == other.slot && generation == other.generation;
+        }
+    };
+
+    struct GroupKey {
+        size_t deviceIndex;
+        size_t channelIndex;
+        size_t groupIndex;
+    };
+
+    struct AssociationSource {
+        size_t deviceIndex;
+        size_t channelIndex;
+        size_t groupIndex;
+        std::optional<size_t> targetChannelIndex;
+    };
+
+    struct Change {
+        enum Type {
+            DeviceAdded,
+            DeviceRemoved,
+            GroupCapacityChanged,
+            AssociationAdded,
+            AssociationRemoved
+        };
+
+        Type type;
+        size_t deviceIndex;
+        size_t channelIndex = 0;
+        size_t groupIndex = 0;
+        Association association = {};
+    };
+
+    // Receives the changes of one edit, or of a whole batch once it is committed.
+    // An association added and removed again inside the same batch is not reported.
+    using ChangesListener = std::function<void(const std::vector<Change>&)>;
+
     DevicesModel();
 
     const std::vector<Device>& getDevices() const;
 
-    void addDevice(Device device);
+    // Devices beyond the limits below, or with associations to devices that do not exist, are rejected.
+    bool addDevice(Device device);
 
-    void removeAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association);
+    // Adds all the devices or, if any of them is rejected, none.
+    bool addDevices(std::vector<Device> devices);
 
-    void addAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association);
+    // Replaces the whole network. Associations may point to any of the new devices; handles of the old ones become invalid.
+    bool setDevices(std::vector<Device> devices);
+
+    DeviceHandle getDeviceHandle(size_t deviceIndex) const;
+
+    std::optional<size_t> findDeviceIndex(DeviceHandle handle) const;
+
+    // The last device takes the place of the removed one; associations to both are fixed up through
+    // the reverse index, so the cost does not depend on the network size.
+    bool removeDevice(DeviceHandle handle);
+
+    bool removeAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association);
+
+    bool addAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Association association);
+
+    // Why an association edit was rejected.
+    enum AssociationRejection {
+        NoRejection,
+        UnknownGroup,
+        GroupFull,
+        UnknownTarget,
+        MissingAssociation
+    };
+
+    // Association edits between begin and commit form one transaction: if any of them is rejected
+    // (unknown group, full group, missing association), commit undoes all of them and returns false.
+    void beginAssociationsBatch();
+
+    bool commitAssociationsBatch();
+
+    // The same, reporting the reason of the first rejected edit when the batch is undone.
+    bool commitAssociationsBatch(AssociationRejection& rejection);
+
+    void rollbackAssociationsBatch();
+
+    bool setMaxAssociationsNumber(size_t deviceIndex, size_t channelIndex, size_t groupIndex, uint8_t maxAssociationsNumber);
+
+    size_t addChangesListener(ChangesListener listener);
+
+    void removeChangesListener(size_t listenerId);
 
     const Device* findDeviceByNode(size_t nodeIndex) const;
 
+    // Contiguous copy of all groups and associations for whole-network passes. Built on first use after a change.
+    const FlatAssociations& getFlatAssociations() const;
+
+    // The same layout shared with the caller. It is never modified, later changes build a new one,
+    // so it may be read from another thread while the model is being edited.
+    std::shared_ptr<const FlatAssociations> getFlatAssociationsSnapshot() const;
+
+    // The current network as an immutable version (DevicesVersion). Association edits path-copy only the
+    // edited groups into the previous version, and a device removal only the moved device and the groups it
+    // renumbers, so consecutive versions share everything else.
+    std::shared_ptr<const DevicesVersion> getVersion() const;
+
+    // Brings the associations and group capacities back to those of a version with the same devices,
+    // touching only the groups it does not share with the current one. Fails inside a batch.
+    bool restoreVersion(const DevicesVersion& version);
+
+    // Groups associated to the device: to the whole node and to any of its channels.
+    std::vector<AssociationSource> getIncomingAssociations(size_t targetDeviceIndex) const;
+
+    // Groups associated to the given channel of the device or, for an empty channel, to the whole node.
+    std::vector<AssociationSource> getIncomingAssociations(size_t targetDeviceIndex, std::optional<size_t> targetChannelIndex) const;
+
+    // Z-Wave Long Range node ids end at 4000; free ids up to it are tracked in a bitmap.
+    static constexpr size_t MaxNodeId = 4000;
+
+    // Association rows are packed into 8 bytes (PackedAssociationInfo): device positions take 16 bits,
+    // channels and groups 8 bits each, and a target channel is stored as channel + 1.
+    static constexpr size_t MaxDevicesNumber = 1 << 16;
+    static constexpr size_t MaxChannelsNumber = 255;
+    static constexpr size_t MaxGroupsNumber = 1 << 8;
+
 private:
 
+    static bool fitsLimits(const Device& device, size_t devicesNumber);
+
+    uint32_t acquireSlot(size_t deviceIndex);
+
+    void releaseSlot(uint32_t slot);
+
+    size_t allocateNodeId();
+
+    void markNodeIdUsed(size_t nodeId);
+
+    void markNodeIdFree(size_t nodeId);
+
+    void addIncomingAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, const Association& association);
+
+    void removeIncomingAssociation(size_t deviceIndex, size_t channelIndex, size_t groupIndex, const Association& association);
+
+    // Returns false; inside a batch the first rejection is kept for the commit.
+    bool rejectAssociationEdit(AssociationRejection rejection);
+
+    void notify(Change change);
+
+    void suspendChanges();
+
+    void resumeChanges();
+
+    void appendIncomingAssociations(uint32_t slot, std::optional<size_t> targetChannelIndex, std::vector<AssociationSource>& result) const;
+
+private:
+    struct DeviceSlot {
+        uint32_t generation = 0;
+        size_t deviceIndex = 0;
+        bool used = false;
+    };
+
+    struct AppliedEdit {
+        bool added;
+        size_t deviceIndex;
+        size_t channelIndex;
+        size_t groupIndex;
+        size_t position;
+        Association association;
+    };
+
+    struct AssociationsBatch {
+        std::vector<AppliedEdit> appliedEdits;
+        size_t firstChange = 0;
+        AssociationRejection rejection = NoRejection;
+    };
+
+    struct IncomingAssociation {
+        uint32_t sourceSlot;
+        size_t channelIndex;
+        size_t groupIndex;
+        std::optional<size_t> targetChannelIndex;
+    };
+
     std::vector<Device> m_devices;
+    std::unordered_map<size_t, size_t> m_nodeIdsToDevices;
+    std::vector<uint64_t> m_usedNodeIds = std::vector<uint64_t>( MaxNodeId / 64 + 1 );
+    size_t m_firstFreeNodeIdWord = 0;
+
+    std::optional<AssociationsBatch> m_associationsBatch;
+
+    std::map<size_t, ChangesListener> m_changesListeners;
+    size_t m_nextChangesListenerId = 0;
+    std::vector<Change> m_pendingChanges;
+    size_t m_changesSuspended = 0;
+
+    mutable std::shared_ptr<const FlatAssociations> m_flatAssociations;
+
+    // groups edited since m_version was last brought up to date
+    mutable std::shared_ptr<const DevicesVersion> m_version;
+    mutable std::vector<GroupKey> m_staleGroups;
+
+    std::vector<DeviceSlot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<uint32_t> m_deviceSlots;
+    // slot -> target channel bucket (0 is the whole node, channel + 1 otherwise) -> associations
+    std::vector<std::vector<std::vector<IncomingAssociation>>> m_incomingAssociations;
 };
 
 
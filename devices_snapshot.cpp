@@ -0,0 +1,497 @@
+#include "devices_snapshot.h"
+#include "devices_version.h"
+
+#include <QSaveFile>
+
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+constexpr char Magic[8] = { 'A', 'S', 'S', 'O', 'C', 'S', 'N', 'P' };
+constexpr uint32_t ByteOrderMark = 0x01020304;
+
+constexpr size_t RecordSizes[DevicesSnapshot::SectionsCount] = {
+    sizeof(DevicesSnapshot::DeviceRecord),
+    sizeof(DevicesSnapshot::SubDeviceRecord),
+    sizeof(DevicesSnapshot::ItemRecord),
+    sizeof(DevicesSnapshot::ReferenceRecord),
+    sizeof(DevicesSnapshot::Range),
+    sizeof(DevicesSnapshot::GroupRecord),
+    sizeof(DevicesSnapshot::AssociationRecord),
+    sizeof(uint32_t),
+    sizeof(uint32_t),
+    sizeof(char)
+};
+
+bool isInRange(DevicesSnapshot::Range range, uint32_t count) {
+    return range.first <= count && range.count <= count - range.first;
+}
+
+// channels and groups are stored by value in DevicesModel and by pointer in DevicesVersion
+const DevicesModel::AssociationGroup& getGroup(const DevicesModel::AssociationGroup& group) {
+    return group;
+}
+
+const DevicesModel::AssociationGroup& getGroup(const std::shared_ptr<const DevicesModel::AssociationGroup>& group) {
+    return *group;
+}
+
+const std::vector<DevicesModel::AssociationGroup>& getChannel(const std::vector<DevicesModel::AssociationGroup>& groups) {
+    return groups;
+}
+
+const DevicesVersion::Channel& getChannel(const std::shared_ptr<const DevicesVersion::Channel>& groups) {
+    return *groups;
+}
+
+class SnapshotWriter {
+public:
+    uint32_t addString(const std::string& string) {
+        auto it = m_stringIndices.find( string );
+        if ( it != m_stringIndices.end() )
+            return it->second;
+
+        const auto stringIndex = static_cast<uint32_t>( m_stringOffsets.size() - 1 );
+
+        m_stringChars += string;
+        m_stringOffsets.push_back( static_cast<uint32_t>( m_stringChars.size() ) );
+        m_stringIndices.emplace( string, stringIndex );
+
+        return stringIndex;
+    }
+
+    DevicesSnapshot::Range addItems(const std::vector<DevicesModel::Item>& items) {
+        const DevicesSnapshot::Range range = { static_cast<uint32_t>( m_items.size() ), static_cast<uint32_t>( items.size() ) };
+
+        for ( const auto& item : items ) {
+            DevicesSnapshot::ItemRecord record;
+            record.name = addString( item.name );
+            record.references = { static_cast<uint32_t>( m_references.size() ), static_cast<uint32_t>( item.references.size() ) };
+
+            for ( const auto& reference : item.references ) {
+                m_references.push_back( { static_cast<uint32_t>( reference.channelIndex ), addString( reference.cc ) } );
+            }
+
+            m_items.push_back( record );
+        }
+
+        return range;
+    }
+
+    // device gives everything but the groups, which come from channels
+    template<typename Channels>
+    void addDevice(const DevicesModel::Device& device, const Channels& channels) {
+        DevicesSnapshot::DeviceRecord record;
+        record.nodeId = static_cast<uint32_t>( device.nodeId );
+        record.name = addString( device.name );
+        record.icon = addString( device.icon );
+        record.items = addItems( device.items );
+        record.channels = { static_cast<uint32_t>( m_channels.size() ), static_cast<uint32_t>( channels.size() ) };
+        record.children = { static_cast<uint32_t>( m_subDevices.size() ), static_cast<uint32_t>( device.children.size() ) };
+
+        for ( const auto& channel : channels ) {
+            const auto& groups = getChannel( channel );
+            m_channels.push_back( { static_cast<uint32_t>( m_groups.size() ), static_cast<uint32_t>( groups.size() ) } );
+
+            for ( const auto& groupEntry : groups ) {
+                const auto& group = getGroup( groupEntry );
+
+                DevicesSnapshot::GroupRecord groupRecord;
+                groupRecord.name = addString( group.name );
+                groupRecord.profile = addString( group.profile );
+                groupRecord.maxAssociationsNumber = group.maxAssociationsNumber;
+                groupRecord.associations = { static_cast<uint32_t>( m_associations.size() ), static_cast<uint32_t>( group.associations.size() ) };
+                groupRecord.commands = { static_cast<uint32_t>( m_commands.size() ), static_cast<uint32_t>( group.commands.size() ) };
+
+                for ( const auto& association : group.associations ) {
+                    m_associations.push_back( { static_cast<uint32_t>( association.deviceIndex ),
+                                                association.channelIndex ? static_cast<uint32_t>( *association.channelIndex ) : DevicesSnapshot::NoChannel } );
+                }
+
+                for ( auto command : group.commands ) {
+                    m_commands.push_back( static_cast<uint32_t>( command ) );
+                }
+
+                m_groups.push_back( groupRecord );
+            }
+        }
+
+        for ( const auto& subDevice : device.children ) {
+            m_subDevices.push_back( { addString( subDevice.name ), addString( subDevice.icon ), addItems( subDevice.items ) } );
+        }
+
+        m_devices.push_back( record );
+    }
+
+    bool write(QIODevice& device, uint64_t journalSequence, QString& error) const {
+        DevicesSnapshot::Header header = {};
+        std::memcpy( header.magic, Magic, sizeof(Magic) );
+        header.version = DevicesSnapshot::Version;
+        header.byteOrderMark = ByteOrderMark;
+        header.journalSequence = journalSequence;
+
+        const std::pair<const void*, size_t> sections[DevicesSnapshot::SectionsCount] = {
+            { m_devices.data(), m_devices.size() },
+            { m_subDevices.data(), m_subDevices.size() },
+            { m_items.data(), m_items.size() },
+            { m_references.data(), m_references.size() },
+            { m_channels.data(), m_channels.size() },
+            { m_groups.data(), m_groups.size() },
+            { m_associations.data(), m_associations.size() },
+            { m_commands.data(), m_commands.size() },
+            { m_stringOffsets.data(), m_stringOffsets.size() },
+            { m_stringChars.data(), m_stringChars.size() }
+        };
+
+        uint64_t offset = sizeof(header);
+        for ( size_t section = 0; section < DevicesSnapshot::SectionsCount; ++section ) {
+            header.sections[section] = { static_cast<uint32_t>( offset ), static_cast<uint32_t>( sections[section].second ) };
+            offset += sections[section].second * RecordSizes[section];
+        }
+
+        if ( offset > UINT32_MAX ) {
+            error = "The network is too large for a snapshot";
+            return false;
+        }
+
+        if ( device.write( reinterpret_cast<const char*>( &header ), sizeof(header) ) != sizeof(header) ) {
+            error = device.errorString();
+            return false;
+        }
+
+        for ( size_t section = 0; section < DevicesSnapshot::SectionsCount; ++section ) {
+            const auto size = static_cast<qint64>( sections[section].second * RecordSizes[section] );
+
+            if ( size > 0 && device.write( static_cast<const char*>( sections[section].first ), size ) != size ) {
+                error = device.errorString();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    std::vector<DevicesSnapshot::DeviceRecord> m_devices;
+    std::vector<DevicesSnapshot::SubDeviceRecord> m_subDevices;
+    std::vector<DevicesSnapshot::ItemRecord> m_items;
+    std::vector<DevicesSnapshot::ReferenceRecord> m_references;
+    std::vector<DevicesSnapshot::Range> m_channels;
+    std::vector<DevicesSnapshot::GroupRecord> m_groups;
+    std::vector<DevicesSnapshot::AssociationRecord> m_associations;
+    std::vector<uint32_t> m_commands;
+
+    std::unordered_map<std::string, uint32_t> m_stringIndices;
+    std::vector<uint32_t> m_stringOffsets = { 0 };
+    std::string m_stringChars;
+};
+
+bool saveSnapshot(const SnapshotWriter& writer, uint64_t journalSequence, const QString& fileName, QString& error) {
+    QSaveFile file( fileName );
+
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        error = "Cannot open " + fileName;
+        return false;
+    }
+
+    if ( !writer.write( file, journalSequence, error ) ) {
+        file.cancelWriting();
+        return false;
+    }
+
+    if ( !file.commit() ) {
+        error = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+bool DevicesSnapshot::save(const DevicesModel& model, const QString& fileName, QString& error) {
+    return save( model.getDevices(), 0, fileName, error );
+}
+
+bool DevicesSnapshot::save(const std::vector<DevicesModel::Device>& devices, uint64_t journalSequence, const QString& fileName, QString& error) {
+    SnapshotWriter writer;
+
+    for ( const auto& device : devices ) {
+        writer.addDevice( device, device.channelsToGroups );
+    }
+
+    return saveSnapshot( writer, journalSequence, fileName, error );
+}
+
+bool DevicesSnapshot::save(const DevicesVersion& version, uint64_t journalSequence, const QString& fileName, QString& error) {
+    SnapshotWriter writer;
+
+    for ( size_t deviceIndex = 0; deviceIndex < version.getDevicesCount(); ++deviceIndex ) {
+        const auto& device = version.getDevice( deviceIndex );
+        writer.addDevice( *device.properties, device.channels );
+    }
+
+    return saveSnapshot( writer, journalSequence, fileName, error );
+}
+
+bool DevicesSnapshot::open(const QString& fileName, QString& error) {
+    close();
+
+    m_file.setFileName( fileName );
+
+    if ( !m_file.open( QIODevice::ReadOnly ) ) {
+        error = "Cannot open " + fileName;
+        return false;
+    }
+
+    m_size = m_file.size();
+
+    if ( m_size < static_cast<qint64>( sizeof(Header) ) ) {
+        error = "The file is not a network snapshot";
+        close();
+        return false;
+    }
+
+    m_data = m_file.map( 0, m_size );
+
+    if ( !m_data ) {
+        error = "Cannot map " + fileName;
+        close();
+        return false;
+    }
+
+    if ( !validate( error ) ) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void DevicesSnapshot::close() {
+    if ( m_data )
+        m_file.unmap( const_cast<uchar*>( m_data ) );
+
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+uint64_t DevicesSnapshot::getJournalSequence() const {
+    return m_data ? reinterpret_cast<const Header*>( m_data )->journalSequence : 0;
+}
+
+size_t DevicesSnapshot::getDevicesCount() const {
+    return m_data ? reinterpret_cast<const Header*>( m_data )->sections[DevicesSection].count : 0;
+}
+
+std::vector<DevicesModel::Device> DevicesSnapshot::readDevices() const {
+    std::vector<DevicesModel::Device> devices( getDevicesCount() );
+
+    const auto deviceRecords = getSection<DeviceRecord>( DevicesSection );
+    const auto subDeviceRecords = getSection<SubDeviceRecord>( SubDevicesSection );
+    const auto channelRecords = getSection<Range>( ChannelsSection );
+    const auto groupRecords = getSection<GroupRecord>( GroupsSection );
+    const auto associationRecords = getSection<AssociationRecord>( AssociationsSection );
+    const auto commandRecords = getSection<uint32_t>( CommandsSection );
+
+    for ( size_t deviceIndex = 0; deviceIndex < devices.size(); ++deviceIndex ) {
+        const auto& record = deviceRecords[deviceIndex];
+        auto& device = devices[deviceIndex];
+
+        device.nodeId = record.nodeId;
+        device.name = getString( record.name );
+        device.icon = getString( record.icon );
+        device.items = readItems( record.items );
+
+        device.channelsToGroups.resize( record.channels.count );
+        for ( uint32_t channelIndex = 0; channelIndex < record.channels.count; ++channelIndex ) {
+            const auto& channelRecord = channelRecords[record.channels.first + channelIndex];
+            auto& groups = device.channelsToGroups[channelIndex];
+
+            groups.resize( channelRecord.count );
+            for ( uint32_t groupIndex = 0; groupIndex < channelRecord.count; ++groupIndex ) {
+                const auto& groupRecord = groupRecords[channelRecord.first + groupIndex];
+                auto& group = groups[groupIndex];
+
+                group.name = getString( groupRecord.name );
+                group.profile = getString( groupRecord.profile );
+                group.maxAssociationsNumber = static_cast<uint8_t>( groupRecord.maxAssociationsNumber );
+
+                group.associations.reserve( groupRecord.associations.count );
+                for ( uint32_t index = 0; index < groupRecord.associations.count; ++index ) {
+                    const auto& associationRecord = associationRecords[groupRecord.associations.first + index];
+
+                    group.associations.push_back( { associationRecord.deviceIndex,
+                                                    associationRecord.channelIndex == NoChannel ? std::optional<size_t>() :
+                                                                                                  std::optional<size_t>( associationRecord.channelIndex ) } );
+                }
+
+                group.commands.assign( commandRecords + groupRecord.commands.first,
+                                       commandRecords + groupRecord.commands.first + groupRecord.commands.count );
+            }
+        }
+
+        device.children.resize( record.children.count );
+        for ( uint32_t childIndex = 0; childIndex < record.children.count; ++childIndex ) {
+            const auto& subDeviceRecord = subDeviceRecords[record.children.first + childIndex];
+            auto& subDevice = device.children[childIndex];
+
+            subDevice.name = getString( subDeviceRecord.name );
+            subDevice.icon = getString( subDeviceRecord.icon );
+            subDevice.items = readItems( subDeviceRecord.items );
+        }
+    }
+
+    return devices;
+}
+
+template<typename Record>
+const Record* DevicesSnapshot::getSection(Section section) const {
+    return reinterpret_cast<const Record*>( m_data + reinterpret_cast<const Header*>( m_data )->sections[section].first );
+}
+
+std::string_view DevicesSnapshot::getString(uint32_t stringIndex) const {
+    const auto offsets = getSection<uint32_t>( StringOffsetsSection );
+
+    return std::string_view( getSection<char>( StringCharsSection ) + offsets[stringIndex], offsets[stringIndex + 1] - offsets[stringIndex] );
+}
+
+std::vector<DevicesModel::Item> DevicesSnapshot::readItems(Range items) const {
+    std::vector<DevicesModel::Item> result( items.count );
+
+    const auto itemRecords = getSection<ItemRecord>( ItemsSection );
+    const auto referenceRecords = getSection<ReferenceRecord>( ReferencesSection );
+
+    for ( uint32_t index = 0; index < items.count; ++index ) {
+        const auto& record = itemRecords[items.first + index];
+
+        result[index].name = getString( record.name );
+        result[index].references.reserve( record.references.count );
+
+        for ( uint32_t referenceIndex = 0; referenceIndex < record.references.count; ++referenceIndex ) {
+            const auto& referenceRecord = referenceRecords[record.references.first + referenceIndex];
+
+            result[index].references.push_back( { referenceRecord.channelIndex, std::string( getString( referenceRecord.cc ) ) } );
+        }
+    }
+
+    return result;
+}
+
+bool DevicesSnapshot::validate(QString& error) const {
+    if ( std::memcmp( m_data, Magic, sizeof(Magic) ) != 0 ) {
+        error = "The file is not a network snapshot";
+        return false;
+    }
+
+    const auto& header = *reinterpret_cast<const Header*>( m_data );
+
+    if ( header.version != Version ) {
+        error = "Unsupported snapshot version " + QString::number( header.version );
+        return false;
+    }
+
+    if ( header.byteOrderMark != ByteOrderMark ) {
+        error = "The snapshot was written on a machine with a different byte order";
+        return false;
+    }
+
+    for ( size_t section = 0; section < SectionsCount; ++section ) {
+        const auto& range = header.sections[section];
+
+        if ( range.first % alignof(uint32_t) != 0 ||
+             range.first + static_cast<uint64_t>( range.count ) * RecordSizes[section] > static_cast<uint64_t>( m_size ) ) {
+            error = "The snapshot is truncated or corrupted";
+            return false;
+        }
+    }
+
+    auto sectionSize = [&header](Section section) {
+        return header.sections[section].count;
+    };
+
+    const auto offsets = getSection<uint32_t>( StringOffsetsSection );
+    if ( sectionSize( StringOffsetsSection ) == 0 || offsets[0] != 0 ) {
+        error = "The snapshot string table is corrupted";
+        return false;
+    }
+
+    for ( uint32_t index = 1; index < sectionSize( StringOffsetsSection ); ++index ) {
+        if ( offsets[index] < offsets[index - 1] || offsets[index] > sectionSize( StringCharsSection ) ) {
+            error = "The snapshot string table is corrupted";
+            return false;
+        }
+    }
+
+    const uint32_t stringsCount = sectionSize( StringOffsetsSection ) - 1;
+    bool valid = true;
+
+    auto checkItems = [&](Range items) {
+        valid = valid && isInRange( items, sectionSize( ItemsSection ) );
+    };
+
+    {
+        const auto records = getSection<DeviceRecord>( DevicesSection );
+        for ( uint32_t index = 0; valid && index < sectionSize( DevicesSection ); ++index ) {
+            valid = records[index].name < stringsCount && records[index].icon < stringsCount &&
+                    isInRange( records[index].channels, sectionSize( ChannelsSection ) ) &&
+                    isInRange( records[index].children, sectionSize( SubDevicesSection ) );
+            checkItems( records[index].items );
+        }
+    }
+
+    {
+        const auto records = getSection<SubDeviceRecord>( SubDevicesSection );
+        for ( uint32_t index = 0; valid && index < sectionSize( SubDevicesSection ); ++index ) {
+            valid = records[index].name < stringsCount && records[index].icon < stringsCount;
+            checkItems( records[index].items );
+        }
+    }
+
+    {
+        const auto records = getSection<ItemRecord>( ItemsSection );
+        for ( uint32_t index = 0; valid && index < sectionSize( ItemsSection ); ++index ) {
+            valid = records[index].name < stringsCount && isInRange( records[index].references, sectionSize( ReferencesSection ) );
+        }
+    }
+
+    {
+        const auto records = getSection<ReferenceRecord>( ReferencesSection );
+        for ( uint32_t index = 0; valid && index < sectionSize( ReferencesSection ); ++index ) {
+            valid = records[index].cc < stringsCount;
+        }
+    }
+
+    {
+        const auto records = getSection<Range>( ChannelsSection );
+        for ( uint32_t index = 0; valid && index < sectionSize( ChannelsSection ); ++index ) {
+            valid = isInRange( records[index], sectionSize( GroupsSection ) );
+        }
+    }
+
+    {
+        const auto records = getSection<GroupRecord>( GroupsSection );
+        for ( uint32_t index = 0; valid && index < sectionSize( GroupsSection ); ++index ) {
+            valid = records[index].name < stringsCount && records[index].profile < stringsCount &&
+                    records[index].maxAssociationsNumber <= UINT8_MAX &&
+                    isInRange( records[index].associations, sectionSize( AssociationsSection ) ) &&
+                    isInRange( records[index].commands, sectionSize( CommandsSection ) );
+        }
+    }
+
+    {
+        const auto records = getSection<AssociationRecord>( AssociationsSection );
+        for ( uint32_t index = 0; valid && index < sectionSize( AssociationsSection ); ++index ) {
+            valid = records[index].deviceIndex < sectionSize( DevicesSection );
+        }
+    }
+
+    if ( !valid ) {
+        error = "The snapshot is truncated or corrupted";
+        return false;
+    }
+
+    return true;
+}
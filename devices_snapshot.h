@@ -0,0 +1,124 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "devices_model.h"
+
+class DevicesVersion;
+
+// Versioned binary image of a whole network. The file is memory-mapped and every section is a flat array of
+// 32-bit records, so opening it only checks the header and the record ranges; strings are kept once in a
+// shared table. There is no read path in place: readDevices() copies every record and every string into
+// editable devices, so loading a network costs a full pass over it, only without any text parsing.
+class DevicesSnapshot
+{
+public:
+    static constexpr uint32_t Version = 2;
+
+    static bool save(const DevicesModel& model, const QString& fileName, QString& error);
+
+    // journalSequence is the last journal record already contained in the devices.
+    static bool save(const std::vector<DevicesModel::Device>& devices, uint64_t journalSequence, const QString& fileName, QString& error);
+
+    // Reads nothing but the version, so it may run on any thread while the model changes.
+    static bool save(const DevicesVersion& version, uint64_t journalSequence, const QString& fileName, QString& error);
+
+    bool open(const QString& fileName, QString& error);
+
+    void close();
+
+    uint64_t getJournalSequence() const;
+
+    size_t getDevicesCount() const;
+
+    std::vector<DevicesModel::Device> readDevices() const;
+
+public:
+    enum Section {
+        DevicesSection,
+        SubDevicesSection,
+        ItemsSection,
+        ReferencesSection,
+        ChannelsSection,
+        GroupsSection,
+        AssociationsSection,
+        CommandsSection,
+        StringOffsetsSection,
+        StringCharsSection,
+        SectionsCount
+    };
+
+    struct Range {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct DeviceRecord {
+        uint32_t nodeId;
+        uint32_t name;
+        uint32_t icon;
+        Range items;
+        Range channels;
+        Range children;
+    };
+
+    struct SubDeviceRecord {
+        uint32_t name;
+        uint32_t icon;
+        Range items;
+    };
+
+    struct ItemRecord {
+        uint32_t name;
+        Range references;
+    };
+
+    struct ReferenceRecord {
+        uint32_t channelIndex;
+        uint32_t cc;
+    };
+
+    struct GroupRecord {
+        uint32_t name;
+        uint32_t profile;
+        uint32_t maxAssociationsNumber;
+        Range associations;
+        Range commands;
+    };
+
+    // channelIndex is NoChannel for an association to the whole node
+    struct AssociationRecord {
+        uint32_t deviceIndex;
+        uint32_t channelIndex;
+    };
+
+    static constexpr uint32_t NoChannel = UINT32_MAX;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        uint64_t journalSequence;
+        Range sections[SectionsCount];
+    };
+
+private:
+    template<typename Record>
+    const Record* getSection(Section section) const;
+
+    std::string_view getString(uint32_t stringIndex) const;
+
+    std::vector<DevicesModel::Item> readItems(Range items) const;
+
+    bool validate(QString& error) const;
+
+private:
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+};
@@ -0,0 +1,166 @@
+#include "devices_tree_model.h"
+
+// internal id of a device row is 0, of a subdevice row the index of its device + 1
+
+DevicesTreeModel::DevicesTreeModel(DevicesModel& model, QObject* parent) :
+    QAbstractItemModel(parent),
+    m_model(model)
+{
+    reset();
+
+    m_changesListenerId = m_model.addChangesListener( [this](const std::vector<DevicesModel::Change>& changes) {
+        applyChanges( changes );
+    } );
+}
+
+DevicesTreeModel::~DevicesTreeModel() {
+    m_model.removeChangesListener( m_changesListenerId );
+}
+
+size_t DevicesTreeModel::getDeviceIndex(const QModelIndex& index) {
+    return index.internalId() == 0 ? static_cast<size_t>( index.row() ) : static_cast<size_t>( index.internalId() - 1 );
+}
+
+std::optional<size_t> DevicesTreeModel::getSubDeviceIndex(const QModelIndex& index) {
+    return index.internalId() == 0 ? std::optional<size_t>() : std::optional<size_t>( index.row() );
+}
+
+QModelIndex DevicesTreeModel::index(int row, int column, const QModelIndex& parent) const {
+    if ( row < 0 || column != 0 )
+        return {};
+
+    if ( !parent.isValid() )
+        return static_cast<size_t>( row ) < m_childrenCounts.size() ? createIndex( row, column, quintptr( 0 ) ) : QModelIndex();
+
+    if ( parent.internalId() != 0 || static_cast<uint32_t>( row ) >= m_childrenCounts[parent.row()] )
+        return {};
+
+    return createIndex( row, column, quintptr( parent.row() + 1 ) );
+}
+
+QModelIndex DevicesTreeModel::parent(const QModelIndex& child) const {
+    if ( !child.isValid() || child.internalId() == 0 )
+        return {};
+
+    return createIndex( static_cast<int>( child.internalId() - 1 ), 0, quintptr( 0 ) );
+}
+
+int DevicesTreeModel::rowCount(const QModelIndex& parent) const {
+    if ( !parent.isValid() )
+        return static_cast<int>( m_childrenCounts.size() );
+
+    return parent.internalId() == 0 ? static_cast<int>( m_childrenCounts[parent.row()] ) : 0;
+}
+
+int DevicesTreeModel::columnCount(const QModelIndex&) const {
+    return 1;
+}
+
+QVariant DevicesTreeModel::data(const QModelIndex& index, int role) const {
+    if ( !index.isValid() || role != Qt::DisplayRole )
+        return {};
+
+    // between the change of DevicesModel and the matching row signals a row may already be gone
+    const auto& devices = m_model.getDevices();
+    const size_t deviceIndex = getDeviceIndex( index );
+    if ( deviceIndex >= devices.size() )
+        return {};
+
+    const auto& device = devices[deviceIndex];
+
+    if ( const auto subDeviceIndex = getSubDeviceIndex( index ) ) {
+        return *subDeviceIndex < device.children.size() ? QString::fromStdString( device.children[*subDeviceIndex].name ) : QVariant();
+    }
+
+    return QString::fromStdString( device.name ) + " (node: " + QString::number( device.nodeId ) + ")";
+}
+
+void DevicesTreeModel::applyChanges(const std::vector<DevicesModel::Change>& changes) {
+    const size_t firstAdded = m_childrenCounts.size();
+    size_t addedCount = 0;
+    size_t removedCount = 0;
+    size_t removedIndex = 0;
+    bool unordered = false;
+
+    for ( const auto& change : changes ) {
+        if ( change.type == DevicesModel::Change::DeviceAdded ) {
+            unordered = unordered || removedCount > 0 || change.deviceIndex != firstAdded + addedCount;
+            ++addedCount;
+        }
+        else if ( change.type == DevicesModel::Change::DeviceRemoved ) {
+            removedIndex = change.deviceIndex;
+            ++removedCount;
+        }
+    }
+
+    // appended devices and a single removal are applied in place, anything else (setDevices) resets the tree
+    if ( unordered || removedCount > 1 || ( removedCount == 1 && addedCount > 0 ) ) {
+        reset();
+        return;
+    }
+
+    if ( removedCount == 1 ) {
+        removeDevice( removedIndex );
+        return;
+    }
+
+    if ( addedCount == 0 )
+        return;
+
+    beginInsertRows( {}, static_cast<int>( firstAdded ), static_cast<int>( firstAdded + addedCount ) - 1 );
+
+    for ( size_t deviceIndex = firstAdded; deviceIndex < firstAdded + addedCount; ++deviceIndex ) {
+        m_childrenCounts.push_back( static_cast<uint32_t>( m_model.getDevices()[deviceIndex].children.size() ) );
+    }
+
+    endInsertRows();
+}
+
+void DevicesTreeModel::removeDevice(size_t deviceIndex) {
+    const size_t lastIndex = m_childrenCounts.size() - 1;
+
+    beginRemoveRows( {}, static_cast<int>( lastIndex ), static_cast<int>( lastIndex ) );
+    m_childrenCounts.pop_back();
+    endRemoveRows();
+
+    // the last device took the place of the removed one
+    if ( deviceIndex < lastIndex ) {
+        updateChildren( deviceIndex );
+
+        const auto deviceModelIndex = index( static_cast<int>( deviceIndex ), 0 );
+        emit dataChanged( deviceModelIndex, deviceModelIndex );
+    }
+}
+
+void DevicesTreeModel::updateChildren(size_t deviceIndex) {
+    const auto parentIndex = index( static_cast<int>( deviceIndex ), 0 );
+    const auto count = static_cast<uint32_t>( m_model.getDevices()[deviceIndex].children.size() );
+    auto& mirroredCount = m_childrenCounts[deviceIndex];
+
+    if ( count < mirroredCount ) {
+        beginRemoveRows( parentIndex, static_cast<int>( count ), static_cast<int>( mirroredCount ) - 1 );
+        mirroredCount = count;
+        endRemoveRows();
+    }
+    else if ( count > mirroredCount ) {
+        beginInsertRows( parentIndex, static_cast<int>( mirroredCount ), static_cast<int>( count ) - 1 );
+        mirroredCount = count;
+        endInsertRows();
+    }
+
+    if ( count > 0 )
+        emit dataChanged( index( 0, 0, parentIndex ), index( static_cast<int>( count ) - 1, 0, parentIndex ) );
+}
+
+void DevicesTreeModel::reset() {
+    beginResetModel();
+
+    m_childrenCounts.clear();
+    m_childrenCounts.reserve( m_model.getDevices().size() );
+
+    for ( const auto& device : m_model.getDevices() ) {
+        m_childrenCounts.push_back( static_cast<uint32_t>( device.children.size() ) );
+    }
+
+    endResetModel();
+}
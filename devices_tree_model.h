@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QAbstractItemModel>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "devices_model.h"
+
+// Devices as top level rows in DevicesModel order, subdevices as their children. Texts are made from
+// the devices on request, so nothing is copied; only the number of children per device is mirrored,
+// since DevicesModel reports a change after it happened and the views must see the old shape until
+// the matching begin/end calls.
+class DevicesTreeModel : public QAbstractItemModel
+{
+public:
+    explicit DevicesTreeModel(DevicesModel& model, QObject* parent = nullptr);
+
+    ~DevicesTreeModel() override;
+
+    static size_t getDeviceIndex(const QModelIndex& index);
+
+    static std::optional<size_t> getSubDeviceIndex(const QModelIndex& index);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = {}) const override;
+
+    QModelIndex parent(const QModelIndex& child) const override;
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+
+    int columnCount(const QModelIndex& parent = {}) const override;
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    void applyChanges(const std::vector<DevicesModel::Change>& changes);
+
+    void removeDevice(size_t deviceIndex);
+
+    void updateChildren(size_t deviceIndex);
+
+    void reset();
+
+private:
+    DevicesModel& m_model;
+    size_t m_changesListenerId = 0;
+
+    // by device row
+    std::vector<uint32_t> m_childrenCounts;
+};
@@ -0,0 +1,148 @@
+#include "devices_version.h"
+
+namespace {
+
+std::shared_ptr<const DevicesVersion::Device> createDevice(const DevicesModel::Device& device) {
+    auto result = std::make_shared<DevicesVersion::Device>();
+
+    auto properties = std::make_shared<DevicesModel::Device>();
+    static_cast<DevicesModel::SubDeivice&>( *properties ) = device;
+    properties->nodeId = device.nodeId;
+    properties->children = device.children;
+    result->properties = std::move( properties );
+
+    result->channels.reserve( device.channelsToGroups.size() );
+
+    for ( const auto& groups : device.channelsToGroups ) {
+        auto channel = std::make_shared<DevicesVersion::Channel>();
+        channel->reserve( groups.size() );
+
+        for ( const auto& group : groups ) {
+            channel->push_back( std::make_shared<const DevicesVersion::Group>( group ) );
+        }
+
+        result->channels.push_back( std::move( channel ) );
+    }
+
+    return result;
+}
+
+}
+
+DevicesVersion::DevicesVersion(const std::vector<DevicesModel::Device>& devices) {
+    appendDevices( devices, 0 );
+}
+
+size_t DevicesVersion::getDevicesCount() const {
+    return m_devicesCount;
+}
+
+const DevicesVersion::Device& DevicesVersion::getDevice(size_t deviceIndex) const {
+    return *( *m_chunks[deviceIndex / ChunkSize] )[deviceIndex % ChunkSize];
+}
+
+const DevicesVersion::Group& DevicesVersion::getGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const {
+    return *( *getDevice( deviceIndex ).channels[channelIndex] )[groupIndex];
+}
+
+std::shared_ptr<const DevicesVersion> DevicesVersion::withGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Group group) const {
+    auto chunk = std::make_shared<Chunk>( *m_chunks[deviceIndex / ChunkSize] );
+    auto& devicePointer = ( *chunk )[deviceIndex % ChunkSize];
+
+    auto device = std::make_shared<Device>( *devicePointer );
+    auto channel = std::make_shared<Channel>( *device->channels[channelIndex] );
+
+    ( *channel )[groupIndex] = std::make_shared<const Group>( std::move( group ) );
+    device->channels[channelIndex] = std::move( channel );
+    devicePointer = std::move( device );
+
+    std::shared_ptr<DevicesVersion> result( new DevicesVersion( *this ) );
+    result->m_chunks[deviceIndex / ChunkSize] = std::move( chunk );
+
+    return result;
+}
+
+std::shared_ptr<const DevicesVersion> DevicesVersion::withDevices(const std::vector<DevicesModel::Device>& devices, size_t first) const {
+    std::shared_ptr<DevicesVersion> result( new DevicesVersion( *this ) );
+    result->appendDevices( devices, first );
+
+    return result;
+}
+
+std::shared_ptr<const DevicesVersion> DevicesVersion::withoutDevice(size_t deviceIndex) const {
+    std::shared_ptr<DevicesVersion> result( new DevicesVersion( *this ) );
+    const size_t lastIndex = m_devicesCount - 1;
+
+    if ( deviceIndex != lastIndex ) {
+        auto chunk = std::make_shared<Chunk>( *m_chunks[deviceIndex / ChunkSize] );
+        ( *chunk )[deviceIndex % ChunkSize] = ( *m_chunks[lastIndex / ChunkSize] )[lastIndex % ChunkSize];
+        result->m_chunks[deviceIndex / ChunkSize] = std::move( chunk );
+    }
+
+    if ( result->m_chunks.back()->size() == 1 ) {
+        result->m_chunks.pop_back();
+    }
+    else {
+        auto chunk = std::make_shared<Chunk>( *result->m_chunks.back() );
+        chunk->pop_back();
+        result->m_chunks.back() = std::move( chunk );
+    }
+
+    --result->m_devicesCount;
+
+    return result;
+}
+
+bool DevicesVersion::findChangedGroups(const DevicesVersion& other, std::vector<GroupKey>& groups) const {
+    if ( m_devicesCount != other.m_devicesCount )
+        return false;
+
+    for ( size_t chunkIndex = 0; chunkIndex < m_chunks.size(); ++chunkIndex ) {
+        if ( m_chunks[chunkIndex] == other.m_chunks[chunkIndex] )
+            continue;
+
+        for ( size_t index = 0; index < m_chunks[chunkIndex]->size(); ++index ) {
+            const auto& device = ( *m_chunks[chunkIndex] )[index];
+            const auto& otherDevice = ( *other.m_chunks[chunkIndex] )[index];
+
+            if ( device == otherDevice )
+                continue;
+
+            if ( device->channels.size() != otherDevice->channels.size() )
+                return false;
+
+            for ( size_t channelIndex = 0; channelIndex < device->channels.size(); ++channelIndex ) {
+                const auto& channel = device->channels[channelIndex];
+                const auto& otherChannel = otherDevice->channels[channelIndex];
+
+                if ( channel == otherChannel )
+                    continue;
+
+                if ( channel->size() != otherChannel->size() )
+                    return false;
+
+                for ( size_t groupIndex = 0; groupIndex < channel->size(); ++groupIndex ) {
+                    if ( ( *channel )[groupIndex] != ( *otherChannel )[groupIndex] )
+                        groups.push_back( { chunkIndex * ChunkSize + index, channelIndex, groupIndex } );
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void DevicesVersion::appendDevices(const std::vector<DevicesModel::Device>& devices, size_t first) {
+    for ( size_t deviceIndex = first; deviceIndex < devices.size(); ++deviceIndex ) {
+        if ( m_devicesCount % ChunkSize == 0 ) {
+            m_chunks.push_back( std::make_shared<Chunk>() );
+        }
+        else {
+            // the last chunk may be shared with the version this one was copied from
+            m_chunks.back() = std::make_shared<Chunk>( *m_chunks.back() );
+        }
+
+        std::const_pointer_cast<Chunk>( m_chunks.back() )->push_back( createDevice( devices[deviceIndex] ) );
+        ++m_devicesCount;
+    }
+}
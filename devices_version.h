@@ -0,0 +1,58 @@
+#pragma once
+
+#include "devices_model.h"
+
+#include <memory>
+#include <vector>
+
+// An immutable version of the network. Versions share whatever they have in common: replacing a group
+// copies only the path to it (a chunk of device pointers, the device, the channel), so keeping many of
+// them is cheap, and a reader on any thread holding one sees a consistent network while the model changes.
+class DevicesVersion
+{
+public:
+    using Group = DevicesModel::AssociationGroup;
+    using Channel = std::vector<std::shared_ptr<const Group>>;
+    using GroupKey = DevicesModel::GroupKey;
+
+    struct Device {
+        // the device without its association groups
+        std::shared_ptr<const DevicesModel::Device> properties;
+        std::vector<std::shared_ptr<const Channel>> channels;
+    };
+
+    static constexpr size_t ChunkSize = 64;
+
+    explicit DevicesVersion(const std::vector<DevicesModel::Device>& devices);
+
+    size_t getDevicesCount() const;
+
+    const Device& getDevice(size_t deviceIndex) const;
+
+    const Group& getGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const;
+
+    // A new version with the group replaced, sharing everything else with this one.
+    std::shared_ptr<const DevicesVersion> withGroup(size_t deviceIndex, size_t channelIndex, size_t groupIndex, Group group) const;
+
+    // A new version with devices[first, end) appended.
+    std::shared_ptr<const DevicesVersion> withDevices(const std::vector<DevicesModel::Device>& devices, size_t first) const;
+
+    // A new version with the last device moved in place of the device, as DevicesModel::removeDevice() does.
+    // Groups whose associations are renumbered by the removal are left as they are.
+    std::shared_ptr<const DevicesVersion> withoutDevice(size_t deviceIndex) const;
+
+    // Groups that are not shared with the other version, found by comparing pointers along the paths.
+    // Returns false when the versions differ in devices, channels or groups.
+    bool findChangedGroups(const DevicesVersion& other, std::vector<GroupKey>& groups) const;
+
+private:
+    using Chunk = std::vector<std::shared_ptr<const Device>>;
+
+    DevicesVersion() = default;
+
+    void appendDevices(const std::vector<DevicesModel::Device>& devices, size_t first);
+
+private:
+    std::vector<std::shared_ptr<const Chunk>> m_chunks;
+    size_t m_devicesCount = 0;
+};
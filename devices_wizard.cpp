@@ -1,22 +1,27 @@
 #include "devices_wizard.h"
+#include "devices_json.h"
+#include "devices_importer.h"
+#include "devices_snapshot.h"
+#include "devices_tree_model.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QScrollArea>
 #include <QLabel>
 #include <QPushButton>
-#include <QListView>
-#include <QStringListModel>
-#include <QStandardItemModel>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonValueRef>
 #include <QJsonObject>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QProgressBar>
 
 #include <QTextEdit>
 #include <QTreeView>
 #include <QStyledItemDelegate>
 
+
 namespace {
 class ItemDelegate : public QStyledItemDelegate {
     QSize sizeHint(const QStyleOptionViewItem &option,
@@ -33,39 +38,31 @@ DevicesWizard::DevicesWizard(DevicesModel& model, QWidget* parent) : QWidget(par
 
     mainLayout->addWidget(new QLabel("Current ZWave devices List (Double click -> Associations Editor)", this));
 
-    auto listView = new QListView(this);
-    mainLayout->addWidget(listView);
-    listView->setItemDelegate( new ItemDelegate );
-
-    m_listViewModel = new QStringListModel;
-
-    for ( const auto& device : model.getDevices() ) {
-        addDeviceToListView(device);
-    }
+    auto devicesView = new QTreeView(this);
+    mainLayout->addWidget(devicesView);
+    devicesView->setItemDelegate( new ItemDelegate );
+    devicesView->setHeaderHidden( true );
+    devicesView->setUniformRowHeights( true );
 
-    listView->setModel( m_listViewModel );
+    devicesView->setModel( new DevicesTreeModel( m_devicesModel, devicesView ) );
 
-    listView->setToolTip(
+    devicesView->setToolTip(
 R"(This is a list of existing included zwave devices. Each main device is a zwave node.
-Some devices have set of child devices. Each subdevice is under the same node as a parent.
+Some devices have set of child devices. Each subdevice is under the same node as a parent, expand the node to see them.
 You may add a new device to the list declaring it in the textedit below and pressing the button)"
 );
 
-    listView->setEditTriggers( QListView::NoEditTriggers );
+    devicesView->setEditTriggers( QTreeView::NoEditTriggers );
 
     auto editDeviceAssociations = [=]() {
-        const auto index = listView->currentIndex();
-
-        auto it = std::upper_bound( m_parents.begin(), m_parents.end(), index.row() );
+        const auto index = devicesView->currentIndex();
 
-        if ( !m_parents.empty() && it != m_parents.begin() ) {
-            --it;
-            emit deviceSelected( *it,
-                                 index.row() == *it ? std::optional<size_t>() : index.row() - *it - 1 );
+        if ( index.isValid() ) {
+            emit deviceSelected( m_devicesModel.getDeviceHandle( DevicesTreeModel::getDeviceIndex( index ) ), DevicesTreeModel::getSubDeviceIndex( index ) );
         }
     };
 
-    connect( listView, &QListView::doubleClicked, this, editDeviceAssociations);
+    connect( devicesView, &QTreeView::doubleClicked, this, editDeviceAssociations);
 
     auto editDeviceAssociationsButton = new QPushButton( "Edit Selected Device Associations", this );
     connect( editDeviceAssociationsButton, &QPushButton::clicked, this, editDeviceAssociations);
@@ -73,6 +70,20 @@ You may add a new device to the list declaring it in the textedit below and pres
 
     mainLayout->addWidget(editDeviceAssociationsButton);
 
+    auto removeDeviceButton = new QPushButton( "Remove Selected Device", this );
+    removeDeviceButton->setToolTip( "Removes the selected node together with all the associations from and to it." );
+    connect( removeDeviceButton, &QPushButton::clicked, this, [=]() {
+        const auto index = devicesView->currentIndex();
+
+        if ( index.isValid() ) {
+            const size_t deviceIndex = DevicesTreeModel::getDeviceIndex( index );
+
+            m_devicesModel.removeDevice( m_devicesModel.getDeviceHandle( deviceIndex ) );
+        }
+    });
+
+    mainLayout->addWidget(removeDeviceButton);
+
     auto textEdit = new QTextEdit(this);
     textEdit->setFixedHeight(200);
     textEdit->setText(
@@ -143,61 +154,121 @@ R"({
 
         if (jsonDoc.isObject()) {
             DevicesModel::Device device;
+            QString error;
+
+            if ( !parseDeviceJson( jsonDoc.object(), device, error ) ) {
+                QMessageBox::warning( this, "Add New Device", error );
+                return;
+            }
+
+            if ( !m_devicesModel.addDevice( std::move( device ) ) ) {
+                QMessageBox::warning( this, "Add New Device", "The device has too many channels or groups, or the network is full" );
+                return;
+            }
+
+            //listView->
+            //listView->update();
+        }
+    });
+    mainLayout->addWidget(addNewDeviceButton);
+
+    {
+        auto layout = new QHBoxLayout;
 
-            device.name = jsonDoc["name"].toString().toStdString();
+        auto importButton = new QPushButton("Import Devices From Json File", this);
+        importButton->setToolTip("The file must contain a JSON array of device descriptions in the format above.");
+        layout->addWidget(importButton);
 
+        auto importProgressBar = new QProgressBar(this);
+        importProgressBar->setRange(0, 100);
+        importProgressBar->setVisible(false);
+        layout->addWidget(importProgressBar);
 
-            auto channels = jsonDoc["channels"];
-            for ( auto channel : channels.toArray() ) {
-                std::vector< DevicesModel::AssociationGroup > associationGroups;
+        auto cancelImportButton = new QPushButton("Cancel Import", this);
+        cancelImportButton->setVisible(false);
+        layout->addWidget(cancelImportButton);
 
-                auto groups = channel.toObject()["groups"];
+        mainLayout->addLayout(layout);
 
-                for ( auto group : groups.toArray() ) {
-                    DevicesModel::AssociationGroup associationGroup;
-                    auto groupObject = group.toObject();
-                    associationGroup.name = groupObject["name"].toString().toStdString();
-                    associationGroup.profile = groupObject["profile"].toString().toStdString();
-                    associationGroup.maxAssociationsNumber = groupObject["maxAssociationsNumber"].toInt();
+        connect(importButton, &QPushButton::clicked, this, [=]() {
+            const auto fileName = QFileDialog::getOpenFileName( this, "Import Devices", {}, "JSON files (*.json);;All files (*)" );
 
-                    associationGroups.push_back( std::move( associationGroup ) );
+            if ( fileName.isEmpty() )
+                return;
+
+            auto importer = new DevicesImporter( fileName, this );
+
+            importButton->setEnabled(false);
+            importProgressBar->setValue(0);
+            importProgressBar->setVisible(true);
+            cancelImportButton->setVisible(true);
+
+            connect( importer, &DevicesImporter::progressChanged, importProgressBar, &QProgressBar::setValue );
+            connect( cancelImportButton, &QPushButton::clicked, importer, &DevicesImporter::cancel );
+
+            connect( importer, &DevicesImporter::finished, this, [=]() {
+                auto devices = importer->takeDevices();
+
+                if ( !importer->getError().isEmpty() ) {
+                    QMessageBox::warning( this, "Import Devices", importer->getError() );
+                }
+                else if ( !importer->isCancelled() && !m_devicesModel.addDevices( std::move( devices ) ) ) {
+                    QMessageBox::warning( this, "Import Devices", "The devices have too many channels or groups, or do not fit into the network" );
                 }
 
-                device.channelsToGroups.push_back(std::move(associationGroups));
-            }
+                importButton->setEnabled(true);
+                importProgressBar->setVisible(false);
+                cancelImportButton->setVisible(false);
 
-            auto subdevices = jsonDoc["subdevices"];
-            for ( auto subdeviceJson : subdevices.toArray() ) {
-                DevicesModel::SubDeivice subdevice;
+                disconnect( cancelImportButton, nullptr, importer, nullptr );
+                importer->deleteLater();
+            } );
 
-                subdevice.name = subdeviceJson.toObject()["name"].toString().toStdString();
+            importer->start();
+        });
+    }
 
-                device.children.push_back( std::move( subdevice ) );
-            }
+    {
+        auto layout = new QHBoxLayout;
 
-            m_devicesModel.addDevice( std::move( device ) );
-            addDeviceToListView( m_devicesModel.getDevices().back() );
+        auto saveSnapshotButton = new QPushButton("Save Network Snapshot", this);
+        saveSnapshotButton->setToolTip("Saves the whole network to a binary snapshot, which is read back without any text parsing.");
+        layout->addWidget(saveSnapshotButton);
 
-            //listView->
-            //listView->update();
-        }
-    });
-    mainLayout->addWidget(addNewDeviceButton);
+        auto openSnapshotButton = new QPushButton("Open Network Snapshot", this);
+        openSnapshotButton->setToolTip("Replaces the current network with the one saved in the snapshot.");
+        layout->addWidget(openSnapshotButton);
 
-}
+        mainLayout->addLayout(layout);
+
+        connect(saveSnapshotButton, &QPushButton::clicked, this, [this]() {
+            const auto fileName = QFileDialog::getSaveFileName( this, "Save Network Snapshot", {}, "Network snapshots (*.snapshot);;All files (*)" );
+
+            QString error;
+            if ( !fileName.isEmpty() && !DevicesSnapshot::save( m_devicesModel, fileName, error ) )
+                QMessageBox::warning( this, "Save Network Snapshot", error );
+        });
 
-void DevicesWizard::addDeviceToListView( const DevicesModel::Device& device ) {
-    auto row = m_listViewModel->rowCount();
+        connect(openSnapshotButton, &QPushButton::clicked, this, [this]() {
+            const auto fileName = QFileDialog::getOpenFileName( this, "Open Network Snapshot", {}, "Network snapshots (*.snapshot);;All files (*)" );
 
-    m_listViewModel->insertRow( row );
-    auto parentIndex = m_listViewModel->index( row, 0 );
-    m_listViewModel->setData( parentIndex, QString::fromStdString(device.name) + " (node: " + QString::number( device.nodeId ) + ")" );
+            if ( fileName.isEmpty() )
+                return;
 
-    m_listViewModel->insertRows( ++row, device.children.size());
-    m_parents.push_back(parentIndex.row());
+            DevicesSnapshot snapshot;
+            QString error;
 
-    for ( auto& subdevice : device.children ) {
-        m_listViewModel->setData( m_listViewModel->index( row, 0 ), "    " + QString::fromStdString(subdevice.name) );
-        ++row;
+            if ( !snapshot.open( fileName, error ) ) {
+                QMessageBox::warning( this, "Open Network Snapshot", error );
+                return;
+            }
+
+            if ( !m_devicesModel.setDevices( snapshot.readDevices() ) )
+                QMessageBox::warning( this, "Open Network Snapshot", "The snapshot exceeds the network limits" );
+        });
     }
+
+}
+
+DevicesWizard::~DevicesWizard() {
 }
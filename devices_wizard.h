@@ -6,8 +6,6 @@
 
 #include "devices_model.h"
 
-class QAbstractItemModel;
-
 class DevicesWizard : public QWidget
 {
     Q_OBJECT
@@ -15,14 +13,11 @@ class DevicesWizard : public QWidget
 public:
     DevicesWizard(DevicesModel& model, QWidget* parent);
 
-signals:
-    void deviceSelected(size_t deviceIndex, std::optional<size_t> subDeviceIndex);
+    ~DevicesWizard() override;
 
-private:
-    void addDeviceToListView( const DevicesModel::Device& device );
+signals:
+    void deviceSelected(DevicesModel::DeviceHandle device, std::optional<size_t> subDeviceIndex);
 
 private:
     DevicesModel& m_devicesModel;
-    QAbstractItemModel* m_listViewModel;
-    std::vector<int> m_parents;
 };
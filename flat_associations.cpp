@@ -0,0 +1,43 @@
+#include "flat_associations.h"
+
+#include <unordered_map>
+
+FlatAssociations::FlatAssociations(const std::vector<DevicesModel::Device>& devices) {
+    std::unordered_map<std::string, uint32_t> nameIds;
+
+    channelOffsets.reserve( devices.size() + 1 );
+    channelOffsets.push_back( 0 );
+    groupOffsets.push_back( 0 );
+    associationOffsets.push_back( 0 );
+
+    for ( size_t deviceIndex = 0; deviceIndex < devices.size(); ++deviceIndex ) {
+        const auto& channelsToGroups = devices[deviceIndex].channelsToGroups;
+
+        for ( size_t channelIndex = 0; channelIndex < channelsToGroups.size(); ++channelIndex ) {
+            for ( size_t groupIndex = 0; groupIndex < channelsToGroups[channelIndex].size(); ++groupIndex ) {
+                const auto& group = channelsToGroups[channelIndex][groupIndex];
+
+                auto nameIt = nameIds.emplace( group.name, static_cast<uint32_t>( groupNames.size() ) ).first;
+                if ( nameIt->second == groupNames.size() )
+                    groupNames.push_back( group.name );
+
+                groupDevices.push_back( static_cast<uint32_t>( deviceIndex ) );
+                groupChannels.push_back( static_cast<uint32_t>( channelIndex ) );
+                groupIndices.push_back( static_cast<uint32_t>( groupIndex ) );
+                groupNameIds.push_back( nameIt->second );
+                groupMaxAssociations.push_back( group.maxAssociationsNumber );
+
+                for ( const auto& association : group.associations ) {
+                    targetDevices.push_back( static_cast<uint32_t>( association.deviceIndex ) );
+                    targetChannels.push_back( association.channelIndex ? static_cast<uint32_t>( *association.channelIndex + 1 ) : 0 );
+                }
+
+                associationOffsets.push_back( static_cast<uint32_t>( targetDevices.size() ) );
+            }
+
+            groupOffsets.push_back( static_cast<uint32_t>( groupDevices.size() ) );
+        }
+
+        channelOffsets.push_back( static_cast<uint32_t>( groupOffsets.size() - 1 ) );
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "devices_model.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// The association groups of the whole network as flat arrays addressed through offset tables, so a pass over
+// every group or association reads memory linearly instead of chasing the nested device/channel/group vectors.
+// Device d owns channels [channelOffsets[d], channelOffsets[d + 1]), channel c owns groups [groupOffsets[c], groupOffsets[c + 1])
+// and group g owns associations [associationOffsets[g], associationOffsets[g + 1]).
+struct FlatAssociations {
+    std::vector<uint32_t> channelOffsets;
+    std::vector<uint32_t> groupOffsets;
+
+    std::vector<uint32_t> groupDevices;
+    std::vector<uint32_t> groupChannels;
+    std::vector<uint32_t> groupIndices;
+    std::vector<uint32_t> groupNameIds;
+    std::vector<uint8_t> groupMaxAssociations;
+    std::vector<uint32_t> associationOffsets;
+
+    // target channels are stored as channel + 1, 0 is the whole node
+    std::vector<uint32_t> targetDevices;
+    std::vector<uint32_t> targetChannels;
+
+    std::vector<std::string> groupNames;
+
+    explicit FlatAssociations(const std::vector<DevicesModel::Device>& devices);
+
+    size_t getGroupsCount() const {
+        return groupDevices.size();
+    }
+
+    size_t getGroupId(size_t deviceIndex, size_t channelIndex, size_t groupIndex) const {
+        return groupOffsets[channelOffsets[deviceIndex] + channelIndex] + groupIndex;
+    }
+
+    static std::optional<size_t> decodeChannel(uint32_t channel) {
+        return channel == 0 ? std::optional<size_t>() : std::optional<size_t>( channel - 1 );
+    }
+};
@@ -0,0 +1,111 @@
+#include "group_names_index.h"
+#include "flat_associations.h"
+
+#include <algorithm>
+
+namespace {
+
+void sortUnique(std::vector<uint32_t>& ids) {
+    std::sort( ids.begin(), ids.end() );
+    ids.erase( std::unique( ids.begin(), ids.end() ), ids.end() );
+}
+
+}
+
+void GroupNamesIndex::build(const DevicesModel& model) {
+    const auto& flat = model.getFlatAssociations();
+
+    // the flat layout interns names in order of appearance; here ids follow the sorted order of the names
+    std::vector<uint32_t> sortedIds( flat.groupNames.size() );
+    {
+        std::vector<uint32_t> order( flat.groupNames.size() );
+        for ( uint32_t nameId = 0; nameId < order.size(); ++nameId ) {
+            order[nameId] = nameId;
+        }
+
+        std::vector<QString> names;
+        names.reserve( flat.groupNames.size() );
+        for ( const auto& name : flat.groupNames ) {
+            names.push_back( QString::fromStdString( name ) );
+        }
+
+        std::sort( order.begin(), order.end(), [&names](uint32_t left, uint32_t right) {
+            return names[left] < names[right];
+        } );
+
+        m_names.clear();
+        m_names.reserve( names.size() );
+
+        for ( auto nameId : order ) {
+            sortedIds[nameId] = static_cast<uint32_t>( m_names.size() );
+            m_names.push_back( std::move( names[nameId] ) );
+        }
+    }
+
+    const size_t devicesCount = flat.channelOffsets.size() - 1;
+
+    m_deviceNames.assign( devicesCount, {} );
+    m_deviceChannelNames.assign( devicesCount, {} );
+    m_channelNames.clear();
+
+    for ( size_t deviceIndex = 0; deviceIndex < devicesCount; ++deviceIndex ) {
+        const size_t channelsCount = flat.channelOffsets[deviceIndex + 1] - flat.channelOffsets[deviceIndex];
+
+        m_deviceChannelNames[deviceIndex].resize( channelsCount );
+        if ( m_channelNames.size() < channelsCount )
+            m_channelNames.resize( channelsCount );
+    }
+
+    for ( size_t group = 0; group < flat.getGroupsCount(); ++group ) {
+        const auto nameId = sortedIds[flat.groupNameIds[group]];
+
+        m_deviceNames[flat.groupDevices[group]].push_back( nameId );
+        m_deviceChannelNames[flat.groupDevices[group]][flat.groupChannels[group]].push_back( nameId );
+        m_channelNames[flat.groupChannels[group]].push_back( nameId );
+    }
+
+    for ( auto& ids : m_deviceNames ) {
+        sortUnique( ids );
+    }
+
+    for ( auto& channels : m_deviceChannelNames ) {
+        for ( auto& ids : channels ) {
+            sortUnique( ids );
+        }
+    }
+
+    for ( auto& ids : m_channelNames ) {
+        sortUnique( ids );
+    }
+}
+
+QStringList GroupNamesIndex::getNames(std::optional<size_t> deviceIndex, std::optional<size_t> channelIndex) const {
+    QStringList result;
+
+    if ( !deviceIndex && !channelIndex ) {
+        for ( const auto& name : m_names ) {
+            result.append( name );
+        }
+
+        return result;
+    }
+
+    const std::vector<uint32_t>* ids = nullptr;
+
+    if ( !deviceIndex )
+        ids = *channelIndex < m_channelNames.size() ? &m_channelNames[*channelIndex] : nullptr;
+    else if ( *deviceIndex >= m_deviceNames.size() )
+        ids = nullptr;
+    else if ( !channelIndex )
+        ids = &m_deviceNames[*deviceIndex];
+    else
+        ids = *channelIndex < m_deviceChannelNames[*deviceIndex].size() ? &m_deviceChannelNames[*deviceIndex][*channelIndex] : nullptr;
+
+    if ( ids ) {
+        for ( auto nameId : *ids ) {
+            result.append( m_names[nameId] );
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "devices_model.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Distinct association group names per device, per channel of a device and per channel number across
+// all devices. Names are interned in sorted order, so each sorted set of ids is also a sorted set of
+// names and a lookup needs neither a sort nor a unique pass. Group names only change with devices,
+// so the index is rebuilt on device changes only.
+class GroupNamesIndex
+{
+public:
+    void build(const DevicesModel& model);
+
+    // An empty device or channel stands for all of them.
+    QStringList getNames(std::optional<size_t> deviceIndex, std::optional<size_t> channelIndex) const;
+
+private:
+    std::vector<QString> m_names;
+
+    std::vector<std::vector<uint32_t>> m_deviceNames;
+    std::vector<std::vector<std::vector<uint32_t>>> m_deviceChannelNames;
+    std::vector<std::vector<uint32_t>> m_channelNames;
+};
@@ -10,13 +10,11 @@
 #include <QStringListModel>
 #include <QLineEdit>
 #include <QGridLayout>
+#include <QShowEvent>
 
-GroupsWizard::GroupsWizard(DevicesModel& model, size_t deviceIndex, size_t channelIndex, size_t groupIndex, QWidget* parent) :
+GroupsWizard::GroupsWizard(DevicesModel& model, QWidget* parent) :
     QWidget(parent),
-    m_devicesModel(model),
-    m_deviceIndex(deviceIndex),
-    m_channelIndex(channelIndex),
-    m_groupIndex(groupIndex)
+    m_devicesModel(model)
 {
     auto mainLayout = new QVBoxLayout(this);
 
@@ -24,14 +22,8 @@ GroupsWizard::GroupsWizard(DevicesModel& model, size_t deviceIndex, size_t chann
     mainLayout->addWidget(backButton);
     connect(backButton, &QPushButton::clicked, this, &GroupsWizard::backButtonClicked);
 
-    auto& device = m_devicesModel.getDevices()[m_deviceIndex];
-
-    mainLayout->addWidget(new QLabel("Device: " + QString::fromStdString(device.name) +
-                                     "\nChannel: " + QString::number(m_channelIndex) +
-                                     "\nGroup Name: " + QString::fromStdString(getGroup().name) +
-                                     "\nGroup Profile: " + QString::fromStdString(getGroup().profile) +
-                                     "\nCurrent Associations Number: " + QString::number(getGroup().associations.size()) +
-                                     "\nMax Associations Number: " + QString::number(getGroup().maxAssociationsNumber) ) );
+    m_groupInfoLabel = new QLabel(this);
+    mainLayout->addWidget(m_groupInfoLabel);
 
     mainLayout->addSpacing( 10 );
 
@@ -58,24 +50,10 @@ GroupsWizard::GroupsWizard(DevicesModel& model, size_t deviceIndex, size_t chann
 
         layout->addWidget(new QLabel("Specific Commands For Target Node"));
 
-        auto targetNodeCombo = new QComboBox(this);
-
-        {
-            QStringList nodesList;
-
-            size_t index = 0;
-            for ( auto& device : m_devicesModel.getDevices() ) {
-                if (index != deviceIndex) {
-                    nodesList.append( QString::number(device.nodeId) + " (" + QString::fromStdString(device.name) + ")" );
-                }
-
-                ++index;
-            }
-
-            targetNodeCombo->setModel( new QStringListModel(nodesList) );
-        }
+        m_targetNodeCombo = new QComboBox(this);
+        m_targetNodeCombo->setModel( new QStringListModel );
 
-        layout->addWidget(targetNodeCombo);
+        layout->addWidget(m_targetNodeCombo);
 
         mainLayout->addLayout(layout);
     }
@@ -131,12 +109,95 @@ GroupsWizard::GroupsWizard(DevicesModel& model, size_t deviceIndex, size_t chann
 
     mainLayout->addLayout(addCommandLayout);
 
+    m_changesListenerId = m_devicesModel.addChangesListener( [this](const std::vector<DevicesModel::Change>& changes) {
+        applyModelChanges( changes );
+    } );
+}
+
+GroupsWizard::~GroupsWizard() {
+    m_devicesModel.removeChangesListener( m_changesListenerId );
+}
+
+void GroupsWizard::setGroup(DevicesModel::DeviceHandle device, size_t channelIndex, size_t groupIndex) {
+    m_deviceHandle = device;
+    m_channelIndex = channelIndex;
+    m_groupIndex = groupIndex;
+
+    updateGroupInfo();
+}
+
+void GroupsWizard::showEvent(QShowEvent* event) {
+    if ( m_groupInfoOutdated )
+        updateGroupInfo();
+
+    QWidget::showEvent( event );
+}
+
+void GroupsWizard::applyModelChanges(const std::vector<DevicesModel::Change>& changes) {
+    const auto deviceIndex = findDeviceIndex();
+
+    // the group is gone with its device
+    if ( !deviceIndex ) {
+        if ( isVisible() )
+            emit backButtonClicked();
+
+        return;
+    }
+
+    bool changed = false;
+
+    for ( const auto& change : changes ) {
+        changed = changed || change.type == DevicesModel::Change::DeviceAdded || change.type == DevicesModel::Change::DeviceRemoved ||
+                  ( change.deviceIndex == *deviceIndex && change.channelIndex == m_channelIndex && change.groupIndex == m_groupIndex );
+    }
+
+    if ( !changed )
+        return;
+
+    if ( isVisible() )
+        updateGroupInfo();
+    else
+        m_groupInfoOutdated = true;
+}
+
+void GroupsWizard::updateGroupInfo() {
+    m_groupInfoOutdated = false;
+
+    const auto deviceIndex = findDeviceIndex();
+    if ( !deviceIndex )
+        return;
+
+    auto& device = m_devicesModel.getDevices()[*deviceIndex];
+
+    m_groupInfoLabel->setText("Device: " + QString::fromStdString(device.name) +
+                              "\nChannel: " + QString::number(m_channelIndex) +
+                              "\nGroup Name: " + QString::fromStdString(getGroup().name) +
+                              "\nGroup Profile: " + QString::fromStdString(getGroup().profile) +
+                              "\nCurrent Associations Number: " + QString::number(getGroup().associations.size()) +
+                              "\nMax Associations Number: " + QString::number(getGroup().maxAssociationsNumber) );
+
+    QStringList nodesList;
+
+    size_t index = 0;
+    for ( auto& otherDevice : m_devicesModel.getDevices() ) {
+        if (index != *deviceIndex) {
+            nodesList.append( QString::number(otherDevice.nodeId) + " (" + QString::fromStdString(otherDevice.name) + ")" );
+        }
+
+        ++index;
+    }
+
+    static_cast< QStringListModel* >( m_targetNodeCombo->model() )->setStringList( nodesList );
 }
 
 const DevicesModel::AssociationGroup& GroupsWizard::getGroup() const {
-    return m_devicesModel.getDevices()[m_deviceIndex].channelsToGroups[m_channelIndex][m_groupIndex];
+    return m_devicesModel.getDevices()[getDeviceIndex()].channelsToGroups[m_channelIndex][m_groupIndex];
 }
 
 size_t GroupsWizard::getDeviceIndex() const {
-    return m_deviceIndex;
+    return *findDeviceIndex();
+}
+
+std::optional<size_t> GroupsWizard::findDeviceIndex() const {
+    return m_deviceHandle ? m_devicesModel.findDeviceIndex( *m_deviceHandle ) : std::optional<size_t>();
 }
@@ -2,28 +2,55 @@
 
 #include <QWidget>
 
+#include <optional>
+
 #include "devices_model.h"
 
+class QComboBox;
+class QLabel;
+
 class GroupsWizard : public QWidget
 {
     Q_OBJECT
 
 public:
-    GroupsWizard(DevicesModel& model, size_t deviceIndex, size_t channelIndex, size_t groupIndex, QWidget* parent);
+    GroupsWizard(DevicesModel& model, QWidget* parent);
+
+    ~GroupsWizard() override;
+
+    void setGroup(DevicesModel::DeviceHandle device, size_t channelIndex, size_t groupIndex);
 
     size_t getDeviceIndex() const;
 
+protected:
+    void showEvent(QShowEvent* event) override;
+
 private:
     const DevicesModel::AssociationGroup& getGroup() const;
 
+    std::optional<size_t> findDeviceIndex() const;
+
+    void applyModelChanges(const std::vector<DevicesModel::Change>& changes);
+
+    void updateGroupInfo();
+
 signals:
     void backButtonClicked();
 
 private:
     DevicesModel& m_devicesModel;
-    size_t m_deviceIndex;
-    size_t m_channelIndex;
-    size_t m_groupIndex;
+    // empty until the first setGroup()
+    std::optional<DevicesModel::DeviceHandle> m_deviceHandle;
+    size_t m_channelIndex = 0;
+    size_t m_groupIndex = 0;
+
+    QLabel* m_groupInfoLabel = nullptr;
+    QComboBox* m_targetNodeCombo = nullptr;
+
+    // a hidden wizard updates the group information when it is shown again
+    bool m_groupInfoOutdated = false;
+
+    size_t m_changesListenerId = 0;
 };
 
 
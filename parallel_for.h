@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Calls function(index) for every index in [0, count) on up to hardware_concurrency() threads, the caller included.
+// Threads claim chunks of chunkSize indices from a shared counter, so a thread that is done early keeps taking the
+// remaining chunks instead of idling while another one finishes a fixed share. Every thread started has at least
+// minCountPerThread indices to go through, since starting and joining one costs about as much as a short loop;
+// below two such shares the loop runs inline.
+template<typename Function>
+void parallelFor(size_t count, size_t chunkSize, size_t minCountPerThread, Function function) {
+    const size_t chunksCount = ( count + chunkSize - 1 ) / chunkSize;
+    const size_t threadsCount = std::min<size_t>( { std::max( 1u, std::thread::hardware_concurrency() ), chunksCount,
+                                                    std::max<size_t>( 1, count / std::max<size_t>( 1, minCountPerThread ) ) } );
+
+    if ( threadsCount <= 1 ) {
+        for ( size_t index = 0; index < count; ++index ) {
+            function( index );
+        }
+
+        return;
+    }
+
+    std::atomic<size_t> nextChunk{ 0 };
+
+    auto worker = [&]() {
+        for ( ;; ) {
+            const size_t chunk = nextChunk.fetch_add( 1, std::memory_order_relaxed );
+            if ( chunk >= chunksCount )
+                return;
+
+            const size_t end = std::min( count, ( chunk + 1 ) * chunkSize );
+            for ( size_t index = chunk * chunkSize; index < end; ++index ) {
+                function( index );
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve( threadsCount - 1 );
+
+    for ( size_t thread = 1; thread < threadsCount; ++thread ) {
+        threads.emplace_back( worker );
+    }
+
+    worker();
+
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Counts with running totals as a Fenwick tree: changing one count, the total before an index and the index
+// a running total falls into all take O(log n), where an array of offsets would be rewritten past the change.
+class PrefixSums
+{
+public:
+    PrefixSums() = default;
+
+    explicit PrefixSums(const std::vector<size_t>& counts) :
+        m_counts(counts),
+        m_tree(counts.size() + 1, 0)
+    {
+        for ( size_t index = 1; index <= counts.size(); ++index ) {
+            m_tree[index] += counts[index - 1];
+
+            const size_t parent = index + ( index & ( 0 - index ) );
+            if ( parent <= counts.size() )
+                m_tree[parent] += m_tree[index];
+        }
+
+        for ( auto count : counts ) {
+            m_total += count;
+        }
+    }
+
+    size_t getSize() const {
+        return m_counts.size();
+    }
+
+    size_t getTotal() const {
+        return m_total;
+    }
+
+    size_t getCount(size_t index) const {
+        return m_counts[index];
+    }
+
+    void setCount(size_t index, size_t count) {
+        const size_t oldCount = m_counts[index];
+        m_counts[index] = count;
+        m_total = m_total - oldCount + count;
+
+        // unsigned wrap-around adds a negative difference just as well
+        for ( size_t node = index + 1; node < m_tree.size(); node += node & ( 0 - node ) ) {
+            m_tree[node] = m_tree[node] - oldCount + count;
+        }
+    }
+
+    // The sum of the counts before index.
+    size_t getOffset(size_t index) const {
+        size_t result = 0;
+
+        for ( size_t node = index; node > 0; node -= node & ( 0 - node ) ) {
+            result += m_tree[node];
+        }
+
+        return result;
+    }
+
+    // The index whose range [getOffset(index), getOffset(index) + getCount(index)) holds value, value < getTotal().
+    size_t find(size_t value) const {
+        size_t step = 1;
+        while ( step * 2 < m_tree.size() ) {
+            step *= 2;
+        }
+
+        size_t index = 0;
+
+        for ( ; step > 0; step /= 2 ) {
+            if ( index + step < m_tree.size() && m_tree[index + step] <= value ) {
+                index += step;
+                value -= m_tree[index];
+            }
+        }
+
+        return index;
+    }
+
+private:
+    std::vector<size_t> m_counts;
+    // m_tree[i] sums the counts (i - lowest bit of i, i]
+    std::vector<size_t> m_tree;
+    size_t m_total = 0;
+};
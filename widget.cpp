@@ -4,63 +4,105 @@
 #include "groups_wizard.h"
 
 #include <QVBoxLayout>
+#include <QStandardPaths>
+#include <QDir>
+#include <QMessageBox>
+#include <QShortcut>
 
 Widget::Widget(QWidget *parent)
-    : QWidget(parent)
+    : QWidget(parent),
+      m_devicesJournal(m_devicesModel),
+      m_devicesHistory(m_devicesModel)
 {
     auto mainLayout = new QVBoxLayout(this);
     setLayout(mainLayout);
 
     resize(800, 800);
 
+    const auto dataPath = QStandardPaths::writableLocation( QStandardPaths::AppDataLocation );
+    QString error;
+
+    if ( !QDir().mkpath( dataPath ) || !m_devicesJournal.open( dataPath + "/network", error ) ) {
+        QMessageBox::warning( this, "Devices Editor", "The network will not be saved: " +
+                              ( error.isEmpty() ? "cannot create " + dataPath : error ) );
+    }
+
+    connect( new QShortcut( QKeySequence::Undo, this ), &QShortcut::activated, this, [this]() {
+        m_devicesHistory.undo();
+    } );
+
+    connect( new QShortcut( QKeySequence::Redo, this ), &QShortcut::activated, this, [this]() {
+        m_devicesHistory.redo();
+    } );
+
     openDevicesWizard();
 }
 
 Widget::~Widget()
 {
-
+    // the wizards listen to the model, so they go before it
+    delete m_devicesWizard;
+    delete m_associationsWizard;
+    delete m_groupsWizard;
 }
 
 void Widget::openDevicesWizard() {
-    auto devicesWizard = new DevicesWizard(m_devicesModel, this);
+    if ( !m_devicesWizard ) {
+        m_devicesWizard = new DevicesWizard(m_devicesModel, this);
 
-    connect( devicesWizard, &DevicesWizard::deviceSelected, this, &Widget::openAssociationsWizard );
+        connect( m_devicesWizard, &DevicesWizard::deviceSelected, this, &Widget::openAssociationsWizard );
+    }
 
     setWindowTitle( "Devices Editor" );
 
-    setCurrentWizard( devicesWizard );
+    setCurrentWizard( m_devicesWizard );
 }
 
 void Widget::setCurrentWizard(QWidget* wizard) {
+    if ( m_currentWizard == wizard )
+        return;
+
     if (m_currentWizard) {
         m_currentWizard->hide();
-        m_currentWizard->deleteLater();
     }
 
-    layout()->addWidget( wizard );
+    if ( layout()->indexOf( wizard ) < 0 )
+        layout()->addWidget( wizard );
+
+    wizard->show();
     m_currentWizard = wizard;
 }
 
-void Widget::openGroupsWizard(size_t devicesIndex, size_t channelIndex, size_t groupIndex) {
-    auto wizard = new GroupsWizard(m_devicesModel, devicesIndex, channelIndex, groupIndex, this);
+void Widget::openGroupsWizard(DevicesModel::DeviceHandle device, size_t channelIndex, size_t groupIndex) {
+    if ( !m_groupsWizard ) {
+        m_groupsWizard = new GroupsWizard(m_devicesModel, this);
 
-    connect( wizard, &GroupsWizard::backButtonClicked, this, [=]() {
-        openAssociationsWizard(wizard->getDeviceIndex(), {});
-    } );
+        connect( m_groupsWizard, &GroupsWizard::backButtonClicked, this, &Widget::showAssociationsWizard );
+    }
+
+    m_groupsWizard->setGroup( device, channelIndex, groupIndex );
 
     setWindowTitle("Association Groups");
 
-    setCurrentWizard( wizard );
+    setCurrentWizard( m_groupsWizard );
 }
 
-void Widget::openAssociationsWizard(size_t deviceIndex, std::optional<size_t> subIndex) {
-    auto wizard = new AssociationsWizard(m_devicesModel, deviceIndex, subIndex, this);
+void Widget::openAssociationsWizard(DevicesModel::DeviceHandle device, std::optional<size_t> subIndex) {
+    if ( !m_associationsWizard ) {
+        m_associationsWizard = new AssociationsWizard(m_devicesModel, device, subIndex, this);
 
+        connect(m_associationsWizard, &AssociationsWizard::backClicked, this, &Widget::openDevicesWizard);
+        connect(m_associationsWizard, &AssociationsWizard::groupsWizardRequested, this, &Widget::openGroupsWizard);
+    }
+    else {
+        m_associationsWizard->setSourceDevice( device, subIndex );
+    }
 
-   setWindowTitle( "Associations Editor" );
+    showAssociationsWizard();
+}
 
-    connect(wizard, &AssociationsWizard::backClicked, this, &Widget::openDevicesWizard);
-    connect(wizard, &AssociationsWizard::groupsWizardRequested, this, &Widget::openGroupsWizard);
+void Widget::showAssociationsWizard() {
+    setWindowTitle( "Associations Editor" );
 
-    setCurrentWizard( wizard );
+    setCurrentWizard( m_associationsWizard );
 }
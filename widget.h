@@ -4,6 +4,12 @@
 
 #include <optional>
 #include "devices_model.h"
+#include "devices_journal.h"
+#include "devices_history.h"
+
+class DevicesWizard;
+class AssociationsWizard;
+class GroupsWizard;
 
 class Widget : public QWidget
 {
@@ -15,15 +21,26 @@ public:
 
     void openDevicesWizard();
 
-    void openGroupsWizard(size_t devicesIndex, size_t channelIndex, size_t groupIndex);
+    void openGroupsWizard(DevicesModel::DeviceHandle device, size_t channelIndex, size_t groupIndex);
 
-    void openAssociationsWizard(size_t deviceIndex, std::optional<size_t> subIndex);
+    void openAssociationsWizard(DevicesModel::DeviceHandle device, std::optional<size_t> subIndex);
 
 private:
 
+    // Back from the groups wizard: the associations wizard as it was left.
+    void showAssociationsWizard();
+
     void setCurrentWizard(QWidget* wizard);
 
 private:
+    // Wizards are created on first use and kept, following the model changes, so switching screens
+    // keeps their filters and selections and rebuilds nothing.
+    DevicesWizard* m_devicesWizard = nullptr;
+    AssociationsWizard* m_associationsWizard = nullptr;
+    GroupsWizard* m_groupsWizard = nullptr;
+
     QWidget* m_currentWizard = nullptr;
     DevicesModel m_devicesModel;
+    DevicesJournal m_devicesJournal;
+    DevicesHistory m_devicesHistory;
 };